@@ -63,8 +63,31 @@ void usb_cdc_handler(void) {
 }
 
 
+//  ***************************************************************************
+/// @brief  Connect to the bus (D+ pull-up on), USB clock must be 48 MHz
+/// @param  none
+/// @return @ref error_t
+//  ***************************************************************************
+error_t usb_cdc_start(void) {
+    if (USBD_Start(&usbd_device) != USBD_OK) return E_FAILED;
+    return E_OK;
+}
+
+
+//  ***************************************************************************
+/// @brief  Disconnect from the bus (D+ pull-up off) before USB clock is lost
+/// @param  none
+/// @return @ref error_t
+//  ***************************************************************************
+error_t usb_cdc_stop(void) {
+    if (USBD_Stop(&usbd_device) != USBD_OK) return E_FAILED;
+    return E_OK;
+}
+
+
 bool usb_cdc_is_usb_connected(void) {
-    return true;
+    // Enumerated by host, bus suspend (cable unplugged) changes the state
+    return (usbd_device.dev_state == USBD_STATE_CONFIGURED);
 }
 
 
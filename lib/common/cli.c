@@ -10,91 +10,178 @@
 
 #define CLI_CMD_INACTIVE_INDEX (-1)
 
+#define CLI_HISTORY_NONE       (0)
+
+typedef enum {
+    CLI_RX_ESC_NONE,
+    CLI_RX_ESC_START,     // ESC received
+    CLI_RX_ESC_CSI        // ESC [ received
+} cli_rx_esc_state_t;
+
 
 static cli_send_data_callback send_data_callback = NULL;
 static cli_receive_data_callback receive_data_callback = NULL;
 static uint8_t tx_ring_buff_data[CLI_TX_BUFF_SIZE];
 static ring_buff_t tx_ring_buff;
+static uint32_t tx_dropped_bytes_qty;
 static uint8_t rx_buff[CLI_RX_BUFF_SIZE];
 static uint32_t rx_buff_index;
 static bool is_rx_overflow;
+static cli_rx_esc_state_t rx_esc_state;
+static bool is_rx_raw_mode;
+static uint8_t history_buff[CLI_HISTORY_BUFF_SIZE];   // '\0' terminated lines, the oldest first
+static uint32_t history_size;
+static uint32_t history_pos;    // browsed line number from the newest one, 1..
 
 static const cli_cmd_t *cli_ext_cmds;
 static uint32_t cli_ext_cmds_qty;
+static bool is_cli_ext_cmds_sorted;
 static int32_t cli_current_cmd_index;
 static uint32_t cli_cmd_argc;
 static const uint8_t *cli_cmd_argv[CLI_CMD_MAX_ARG_QTY];
+static const uint8_t *cli_prompt_msg;
 
 
 static void cli_send_process(void);
 static void cli_rx_process(void);
+static error_t cli_tx_write(const uint8_t *data, uint32_t size, bool is_async);
+static error_t cli_vprintf(bool is_async, const uint8_t *format, va_list va);
 
 static void cli_cmd_start(void);
 static void cli_cmd_process(void);
 static void cli_cmd_break(void);
+static error_t cli_cmd_call(cli_call_state_t state);
+static void cli_cmd_finish(error_t result);
+static void cli_prompt_process(void);
+static int32_t cli_cmd_find(const uint8_t *name);
+static void cli_cmd_complete(void);
 
-static void cli_int_cmd_help(void);
+static void cli_history_add(const uint8_t *line, uint32_t size);
+static const uint8_t *cli_history_get(uint32_t pos);
+static void cli_history_browse(bool is_older);
 
 
 
 
+//  ***************************************************************************
+/// @brief  CLI init
+/// @param  send_cb - send data callback
+/// @param  recv_cb - receive data callback
+/// @param  cli_cmds - commands table, should be sorted by name (strcmp order)
+///         for binary search. Unsorted table works with linear search.
+/// @param  cli_cmds_qty
+/// @return none
+//  ***************************************************************************
 void cli_init(cli_send_data_callback send_cb, cli_receive_data_callback recv_cb, const cli_cmd_t *cli_cmds, uint32_t cli_cmds_qty) {
+    uint32_t i;
+
+
     send_data_callback = send_cb;
     receive_data_callback = recv_cb;
     rx_buff_index = 0;
     is_rx_overflow = false;
     ring_buff_init(&tx_ring_buff, tx_ring_buff_data, sizeof(tx_ring_buff_data));
+    tx_dropped_bytes_qty = 0;
+
+    rx_esc_state = CLI_RX_ESC_NONE;
+    is_rx_raw_mode = false;
+    history_size = 0;
+    history_pos = CLI_HISTORY_NONE;
 
     cli_ext_cmds = cli_cmds;
     cli_ext_cmds_qty = cli_cmds_qty;
+    is_cli_ext_cmds_sorted = true;
+    for (i = 1; i < cli_cmds_qty; i++) {
+        if (strcmp((char*)cli_cmds[i - 1].name, (char*)cli_cmds[i].name) >= 0) is_cli_ext_cmds_sorted = false;
+    }
     cli_current_cmd_index = CLI_CMD_INACTIVE_INDEX;
+    cli_prompt_msg = NULL;
 }
 
 
 void cli_process(void) {
     cli_rx_process();
     cli_cmd_process();
+    cli_prompt_process();
     cli_send_process();
 }
 
 
-error_t cli_print(const uint8_t *str) {
-    uint32_t size;
-    
+//  ***************************************************************************
+/// @brief  Write raw data
+/// @param  data - pointer, can't be NULL
+/// @param  size
+/// @return @ref error_t
+/// @note   Never blocks, see @ref cli_print
+//  ***************************************************************************
+error_t cli_write(const uint8_t *data, uint32_t size) {
+    return cli_tx_write(data, size, false);
+}
 
-    size = strlen((char*)str);
-    return ring_buff_write_block(&tx_ring_buff, str, size);
+
+//  ***************************************************************************
+/// @brief  Write raw data or ask caller to retry later
+/// @param  data - pointer, can't be NULL
+/// @param  size - should be less than CLI_TX_BUFF_SIZE
+/// @return @ref error_t
+/// @note   Never blocks, see @ref cli_print_async
+//  ***************************************************************************
+error_t cli_write_async(const uint8_t *data, uint32_t size) {
+    return cli_tx_write(data, size, true);
 }
 
 
-error_t cli_safe_print(const uint8_t *str) {
-    static timer_t dead_time_timer = 0;
-    timer_t timeout_timer;
-    uint32_t size, block_size, str_index;
+//  ***************************************************************************
+/// @brief  Enable / disable raw RX mode for running command
+/// @param  en_dis - true - enable
+/// @return none
+/// @note   In raw mode CLI doesn't read input (Control-C break included),
+///         command reads binary data by @ref cli_read and is responsible for
+///         its own timeout. Raw mode is disabled when command is finished.
+//  ***************************************************************************
+void cli_set_rx_raw_mode(bool en_dis) {
+    is_rx_raw_mode = en_dis;
+}
 
 
-    if (!timer_triggered(dead_time_timer)) return E_TIMEOUT;
+//  ***************************************************************************
+/// @brief  Read raw data in raw RX mode
+/// @param  data - pointer, can't be NULL
+/// @param  size - pointer, can't be NULL
+/// @param  max_size
+/// @retval data
+/// @retval size - received bytes qty
+/// @return @ref error_t, E_NO_DATA - nothing is received
+//  ***************************************************************************
+error_t cli_read(uint8_t *data, uint32_t *size, uint32_t max_size) {
+    if (!is_rx_raw_mode) return E_FAILED;
+    *size = 0;
+    return receive_data_callback(data, size, max_size);
+}
 
-    size = strlen((char*)str);
-    if (size > sizeof(tx_ring_buff_data)) block_size = sizeof(tx_ring_buff_data);
-    else block_size = size;
-    str_index = 0;
-    timeout_timer = timer_start_ms(100);
-    while(size != 0) {
-        cli_send_process();
-        if (ring_buff_write_block(&tx_ring_buff, &str[str_index], block_size) == E_OK) {
-            str_index += block_size;
-            size -= block_size;
-            if (size > sizeof(tx_ring_buff_data)) block_size = sizeof(tx_ring_buff_data);
-            else block_size = size;
-        }
-        if (timer_triggered(timeout_timer)) {
-            dead_time_timer = timer_start_ms(100);
-            return E_TIMEOUT;
-        }
-    }
-    
-    return E_OK;
+
+//  ***************************************************************************
+/// @brief  Print string
+/// @param  str - pointer, can't be NULL
+/// @return @ref error_t
+/// @note   Never blocks. If TX buffer hasn't enough free space, the whole string
+///         is dropped and counted in dropped bytes counter.
+//  ***************************************************************************
+error_t cli_print(const uint8_t *str) {
+    return cli_tx_write(str, strlen((char*)str), false);
+}
+
+
+//  ***************************************************************************
+/// @brief  Print string or ask caller to retry later
+/// @param  str - pointer, can't be NULL
+/// @return @ref error_t
+/// @note   Never blocks. Returns E_ASYNC_WAIT (nothing is written) if TX buffer
+///         hasn't enough free space now, so CLI command can return E_ASYNC_WAIT
+///         and repeat printing at the next CLI_CALL_REPEATED call.
+//  ***************************************************************************
+error_t cli_print_async(const uint8_t *str) {
+    return cli_tx_write(str, strlen((char*)str), true);
 }
 
 
@@ -102,37 +189,71 @@ error_t cli_safe_print(const uint8_t *str) {
 /// @brief  Print string with formatter
 /// @param  format - format specifiers string
 /// @return @ref error_t
-/// @note   Variadic function
+/// @note   Variadic function. See @ref cli_print
 //  ***************************************************************************
 error_t cli_printf(const uint8_t *format, ...) {
     va_list va;
-    uint8_t printf_buff[CLI_PRINTF_BUFF_SIZE];
+    error_t result;
 
 
     va_start(va, format);
-    vsnprintf((char*)printf_buff, CLI_PRINTF_BUFF_SIZE, (char*)format, va);
+    result = cli_vprintf(false, format, va);
     va_end(va);
 
-    return cli_print(printf_buff);
+    return result;
 }
 
 
 //  ***************************************************************************
-/// @brief  Safe print string with formatter
+/// @brief  Print string with formatter or ask caller to retry later
 /// @param  format - format specifiers string
 /// @return @ref error_t
-/// @note   Variadic function
+/// @note   Variadic function. See @ref cli_print_async
 //  ***************************************************************************
-error_t cli_safe_printf(const uint8_t *format, ...) {
+error_t cli_printf_async(const uint8_t *format, ...) {
     va_list va;
-    uint8_t printf_buff[CLI_PRINTF_BUFF_SIZE];
+    error_t result;
 
 
     va_start(va, format);
-    vsnprintf((char*)printf_buff, CLI_PRINTF_BUFF_SIZE, (char*)format, va);
+    result = cli_vprintf(true, format, va);
     va_end(va);
 
-    return cli_safe_print(printf_buff);
+    return result;
+}
+
+
+uint32_t cli_get_tx_dropped_bytes_qty(void) {
+    return tx_dropped_bytes_qty;
+}
+
+
+//  ***************************************************************************
+/// @brief  "help" command: print commands table
+/// @note   Add it to commands table as usual command
+//  ***************************************************************************
+error_t cli_cmd_help(uint32_t argc, const uint8_t **argv, cli_call_state_t state) {
+    static uint32_t help_item_index;
+    error_t result;
+
+
+    if (state == CLI_CALL_FIRST) {
+        help_item_index = 0;
+        return E_ASYNC_WAIT;
+    }
+    if (state == CLI_CALL_TERMINATE) return E_OK;
+
+    while (help_item_index < cli_ext_cmds_qty) {
+        if (cli_ext_cmds[help_item_index].usage != NULL) {
+            result = cli_printf_async("%s%s %s", ((help_item_index > 0) ? "\r\n" : ""), cli_ext_cmds[help_item_index].name, cli_ext_cmds[help_item_index].usage);
+        }
+        else {
+            result = cli_printf_async("%s%s", ((help_item_index > 0) ? "\r\n" : ""), cli_ext_cmds[help_item_index].name);
+        }
+        if (result == E_ASYNC_WAIT) return E_ASYNC_WAIT;
+        help_item_index++;
+    }
+    return E_OK;
 }
 
 
@@ -158,11 +279,26 @@ static void cli_rx_process(void) {
     uint8_t rx_raw_buff[CLI_RX_RAW_BUFF_SIZE];
 
 
+    if (is_rx_raw_mode) return;
     if (receive_data_callback(rx_raw_buff, &rx_raw_size, sizeof(rx_raw_buff)) == E_OK) {
         for (i = 0; i < rx_raw_size; i++) {
-            if (cli_current_cmd_index == CLI_CMD_INACTIVE_INDEX) {
-                if ((rx_raw_buff[i] >= '\x20') && (rx_raw_buff[i] <= '\x7E')) {     // 20..7E - Printable symbol code
-                    ring_buff_write(&tx_ring_buff, rx_raw_buff[i]);    // echo
+            if ((cli_current_cmd_index == CLI_CMD_INACTIVE_INDEX) && (cli_prompt_msg == NULL)) {
+                // Escape sequences: only arrows up/down (ESC [ A, ESC [ B) are used
+                if (rx_esc_state == CLI_RX_ESC_START) {
+                    rx_esc_state = (rx_raw_buff[i] == '[') ? CLI_RX_ESC_CSI : CLI_RX_ESC_NONE;
+                }
+                else if (rx_esc_state == CLI_RX_ESC_CSI) {
+                    if ((rx_raw_buff[i] >= '\x40') && (rx_raw_buff[i] <= '\x7E')) {    // 40..7E - Final byte
+                        if (rx_raw_buff[i] == 'A') cli_history_browse(true);
+                        else if (rx_raw_buff[i] == 'B') cli_history_browse(false);
+                        rx_esc_state = CLI_RX_ESC_NONE;
+                    }
+                }
+                else if (rx_raw_buff[i] == '\x1B') {    // 1B - Escape code
+                    rx_esc_state = CLI_RX_ESC_START;
+                }
+                else if ((rx_raw_buff[i] >= '\x20') && (rx_raw_buff[i] <= '\x7E')) {     // 20..7E - Printable symbol code
+                    cli_tx_write(&rx_raw_buff[i], 1, false);    // echo
                     if (rx_buff_index < (sizeof(rx_buff) - 1)) {   // last rx_buff byte used for EOL
                         rx_buff[rx_buff_index] = rx_raw_buff[i];
                         rx_buff_index++;
@@ -173,10 +309,13 @@ static void cli_rx_process(void) {
                 }
                 else if (rx_raw_buff[i] == '\x7F') {    // 7F - Backspace code
                     if ((rx_buff_index > 0) && !is_rx_overflow) {
-                        ring_buff_write(&tx_ring_buff, rx_raw_buff[i]);    // echo
+                        cli_tx_write(&rx_raw_buff[i], 1, false);    // echo
                         rx_buff_index--;  // delete last symbol
                     }
                 }
+                else if (rx_raw_buff[i] == '\x09') {    // 09 - Tab code
+                    cli_cmd_complete();
+                }
                 else if (rx_raw_buff[i] == '\x0D') {    // 0D - Enter code
                     cli_cmd_start();
                 }
@@ -189,95 +328,248 @@ static void cli_rx_process(void) {
 }
 
 
+static error_t cli_tx_write(const uint8_t *data, uint32_t size, bool is_async) {
+    if (ring_buff_write_block(&tx_ring_buff, data, size) == E_OK) return E_OK;
+
+    // Data will never fit to TX buffer or caller can't wait
+    if (!is_async || (size > sizeof(tx_ring_buff_data))) {
+        tx_dropped_bytes_qty += size;
+        return E_OUT_OF_MEMORY;
+    }
+    return E_ASYNC_WAIT;
+}
+
+
+static error_t cli_vprintf(bool is_async, const uint8_t *format, va_list va) {
+    uint8_t printf_buff[CLI_PRINTF_BUFF_SIZE];
+
+
+    vsnprintf((char*)printf_buff, CLI_PRINTF_BUFF_SIZE, (char*)format, va);
+    return cli_tx_write(printf_buff, strlen((char*)printf_buff), is_async);
+}
+
+
 
 static void cli_cmd_start(void) {
-    const uint8_t *cli_incorrect_cmd_msg = "CMD not found!";
-    const uint8_t *cli_incorrect_args_msg = "Incorrect arg!";
-    const uint8_t *cli_incorrect_failed_msg = "Failed!";
     error_t result;
   
 
     if (is_rx_overflow) {
-        cli_safe_print("\r\n");
-        cli_safe_print(cli_incorrect_cmd_msg);
-        cli_cmd_argc = 0;
-    }
-    else {
-        rx_buff[rx_buff_index] = '\0';
-        pars_get_tokens_from_string(rx_buff, " ", cli_cmd_argv, CLI_CMD_MAX_ARG_QTY, &cli_cmd_argc);
+        cli_print("\r\n");
+        cli_cmd_finish(E_INVALID_ID);
+        return;
     }
 
+    rx_buff[rx_buff_index] = '\0';
+    cli_history_add(rx_buff, rx_buff_index);
+    history_pos = CLI_HISTORY_NONE;
+    pars_get_tokens_from_string(rx_buff, " ", cli_cmd_argv, CLI_CMD_MAX_ARG_QTY, &cli_cmd_argc);
+    if (cli_cmd_argc == 0) {
+        cli_cmd_finish(E_OK);
+        return;
+    }
 
-    if (cli_cmd_argc > 0) {
-        for (cli_current_cmd_index = (cli_ext_cmds_qty - 1); cli_current_cmd_index > CLI_CMD_INACTIVE_INDEX; cli_current_cmd_index--) {
-            if (strcmp((char*)cli_cmd_argv[0], (char*)cli_ext_cmds[cli_current_cmd_index].name) == 0) break;
-        }
+    cli_current_cmd_index = cli_cmd_find(cli_cmd_argv[0]);
 
-        cli_safe_print("\r\n");
-        if (cli_current_cmd_index != CLI_CMD_INACTIVE_INDEX) {
-            result = cli_ext_cmds[cli_current_cmd_index].func(cli_cmd_argc, cli_cmd_argv, CLI_CALL_FIRST);
-            if (result == E_ASYNC_WAIT) {
-                return;
-            }
-            else {
-                cli_current_cmd_index = CLI_CMD_INACTIVE_INDEX;
-                if (result == E_INVALID_ARG) cli_safe_print(cli_incorrect_args_msg);
-                else if (result == E_FAILED) cli_safe_print(cli_incorrect_failed_msg);
-            }
-        }
-        else if (strcmp((char*)cli_cmd_argv[0], "help") == 0) {
-            cli_int_cmd_help();
-        }
-        else {
-            cli_safe_print(cli_incorrect_cmd_msg);
-        }
+    cli_print("\r\n");
+    if (cli_current_cmd_index == CLI_CMD_INACTIVE_INDEX) {
+        cli_cmd_finish(E_INVALID_ID);
+        return;
     }
 
-    cli_safe_print("\r\n\r\n");
-    cli_print(CLI_PROMPT);
-    rx_buff_index = 0;
-    is_rx_overflow = false;
+    result = cli_cmd_call(CLI_CALL_FIRST);
+    if (result != E_ASYNC_WAIT) cli_cmd_finish(result);
 }
 
 
 static void cli_cmd_process(void) {
+    error_t result;
+
+
     if (cli_current_cmd_index == CLI_CMD_INACTIVE_INDEX) return;
 
-    if (cli_ext_cmds[cli_current_cmd_index].func(cli_cmd_argc, cli_cmd_argv, CLI_CALL_REPEATED) != E_ASYNC_WAIT) {
-        cli_current_cmd_index = CLI_CMD_INACTIVE_INDEX;
-        cli_safe_print("\r\n\r\n");
-        cli_print(CLI_PROMPT);
-        rx_buff_index = 0;
-        is_rx_overflow = false;
-    }
+    result = cli_cmd_call(CLI_CALL_REPEATED);
+    if (result != E_ASYNC_WAIT) cli_cmd_finish(result);
 }
 
 
 static void cli_cmd_break(void) {
     if (cli_current_cmd_index == CLI_CMD_INACTIVE_INDEX) return;
 
-    cli_ext_cmds[cli_current_cmd_index].func(cli_cmd_argc, cli_cmd_argv, CLI_CALL_TERMINATE);
+    cli_cmd_call(CLI_CALL_TERMINATE);
+    cli_cmd_finish(E_OK);
+}
+
+
+static error_t cli_cmd_call(cli_call_state_t state) {
+    return cli_ext_cmds[cli_current_cmd_index].func(cli_cmd_argc, cli_cmd_argv, state);
+}
+
+
+static void cli_cmd_finish(error_t result) {
     cli_current_cmd_index = CLI_CMD_INACTIVE_INDEX;
-    cli_safe_print("\r\n\r\n");
-    cli_print(CLI_PROMPT);
+    is_rx_raw_mode = false;
+
+    if (result == E_INVALID_ID) cli_prompt_msg = "CMD not found!";
+    else if (result == E_INVALID_ARG) cli_prompt_msg = "Incorrect arg!";
+    else if (result == E_FAILED) cli_prompt_msg = "Failed!";
+    else cli_prompt_msg = "";
+    cli_prompt_process();
+}
+
+
+static void cli_prompt_process(void) {
+    if (cli_prompt_msg == NULL) return;
+
+    // Prompt can't be lost: wait for free space in TX buffer
+    if (cli_printf_async("%s\r\n\r\n%s", cli_prompt_msg, CLI_PROMPT) == E_ASYNC_WAIT) return;
+    cli_prompt_msg = NULL;
     rx_buff_index = 0;
     is_rx_overflow = false;
 }
 
 
+static int32_t cli_cmd_find(const uint8_t *name) {
+    int32_t low, high, middle, cmp_result;
 
 
-static void cli_int_cmd_help(void) {
-    uint32_t i;
+    if (!is_cli_ext_cmds_sorted) {
+        for (low = 0; low < (int32_t)cli_ext_cmds_qty; low++) {
+            if (strcmp((char*)name, (char*)cli_ext_cmds[low].name) == 0) return low;
+        }
+        return CLI_CMD_INACTIVE_INDEX;
+    }
+
+    low = 0;
+    high = cli_ext_cmds_qty - 1;
+    while (low <= high) {
+        middle = (low + high) / 2;
+        cmp_result = strcmp((char*)name, (char*)cli_ext_cmds[middle].name);
+        if (cmp_result == 0) return middle;
+        if (cmp_result < 0) high = middle - 1;
+        else low = middle + 1;
+    }
+    return CLI_CMD_INACTIVE_INDEX;
+}
+
+
+//  ***************************************************************************
+/// @brief  Complete command name by typed prefix
+/// @note   Single match is completed with trailing space. Several matches are
+///         completed up to common part, or listed if it's already typed.
+//  ***************************************************************************
+static void cli_cmd_complete(void) {
+    const uint8_t *match_name = NULL;
+    uint32_t matches_qty, common_size, i, j;
+
 
+    if (is_rx_overflow || (memchr(rx_buff, ' ', rx_buff_index) != NULL)) return;   // command name only
 
+    matches_qty = 0;
+    common_size = 0;
     for (i = 0; i < cli_ext_cmds_qty; i++) {
-        if (i > 0) cli_safe_print("\r\n");
-        if (cli_ext_cmds[i].usage != NULL) {
-            cli_safe_printf("%s %s", cli_ext_cmds[i].name, cli_ext_cmds[i].usage);
+        if (strncmp((char*)cli_ext_cmds[i].name, (char*)rx_buff, rx_buff_index) != 0) continue;
+        if (matches_qty == 0) {
+            match_name = cli_ext_cmds[i].name;
+            common_size = strlen((char*)match_name);
         }
         else {
-            cli_safe_print(cli_ext_cmds[i].name);
+            for (j = rx_buff_index; (j < common_size) && (cli_ext_cmds[i].name[j] == match_name[j]); j++);
+            common_size = j;
+        }
+        matches_qty++;
+    }
+    if (matches_qty == 0) return;
+
+    if (common_size > rx_buff_index) {
+        if (common_size >= (sizeof(rx_buff) - 1)) return;
+        cli_tx_write(&match_name[rx_buff_index], (common_size - rx_buff_index), false);    // echo
+        memcpy(&rx_buff[rx_buff_index], &match_name[rx_buff_index], (common_size - rx_buff_index));
+        rx_buff_index = common_size;
+        if (matches_qty == 1) {
+            cli_tx_write(" ", 1, false);    // echo
+            rx_buff[rx_buff_index] = ' ';
+            rx_buff_index++;
         }
     }
+    else if (matches_qty > 1) {
+        for (i = 0; i < cli_ext_cmds_qty; i++) {
+            if (strncmp((char*)cli_ext_cmds[i].name, (char*)rx_buff, rx_buff_index) == 0) cli_printf("\r\n%s", cli_ext_cmds[i].name);
+        }
+        cli_printf("\r\n\r\n%s", CLI_PROMPT);
+        cli_tx_write(rx_buff, rx_buff_index, false);
+    }
+}
+
+
+
+
+//  ***************************************************************************
+/// @brief  Add line to history
+/// @note   The oldest lines are dropped to free space. Repeated line isn't added.
+//  ***************************************************************************
+static void cli_history_add(const uint8_t *line, uint32_t size) {
+    const uint8_t *newest_line;
+    uint32_t drop_size;
+
+
+    if ((size == 0) || ((size + 1) > sizeof(history_buff))) return;
+    newest_line = cli_history_get(1);
+    if ((newest_line != NULL) && (strcmp((char*)newest_line, (char*)line) == 0)) return;
+
+    while ((history_size + size + 1) > sizeof(history_buff)) {
+        drop_size = strlen((char*)history_buff) + 1;
+        memmove(history_buff, &history_buff[drop_size], (history_size - drop_size));
+        history_size -= drop_size;
+    }
+    memcpy(&history_buff[history_size], line, size);
+    history_buff[history_size + size] = '\0';
+    history_size += size + 1;
 }
+
+
+static const uint8_t *cli_history_get(uint32_t pos) {
+    uint32_t i;
+
+
+    if ((pos == CLI_HISTORY_NONE) || (history_size == 0)) return NULL;
+
+    // Go back from the last symbol of the newest line (lines are never empty)
+    i = history_size - 2;
+    while (1) {
+        if ((i == 0) || (history_buff[i - 1] == '\0')) {
+            pos--;
+            if (pos == 0) return &history_buff[i];
+            if (i == 0) return NULL;
+        }
+        i--;
+    }
+}
+
+
+static void cli_history_browse(bool is_older) {
+    const uint8_t *line;
+    uint32_t new_pos;
+
+
+    if (is_older) new_pos = history_pos + 1;
+    else if (history_pos != CLI_HISTORY_NONE) new_pos = history_pos - 1;
+    else return;
+
+    line = cli_history_get(new_pos);
+    if ((line == NULL) && (new_pos != CLI_HISTORY_NONE)) return;   // no more lines
+    history_pos = new_pos;
+
+    if (line == NULL) rx_buff_index = 0;
+    else {
+        rx_buff_index = strlen((char*)line);
+        memcpy(rx_buff, line, rx_buff_index);
+    }
+    is_rx_overflow = false;
+
+    // Redraw line: carriage return, prompt, line, erase to end of line
+    cli_printf("\r%s", CLI_PROMPT);
+    cli_tx_write(rx_buff, rx_buff_index, false);
+    cli_print("\x1B[K");
+}
+
@@ -36,11 +36,20 @@ typedef struct {
 extern void cli_init(cli_send_data_callback send_cb, cli_receive_data_callback recv_cb, const cli_cmd_t *cli_cmds, uint32_t cli_cmds_qty);
 extern void cli_process(void);
 
+extern error_t cli_write(const uint8_t *data, uint32_t size);
+extern error_t cli_write_async(const uint8_t *data, uint32_t size);
 extern error_t cli_print(const uint8_t *str);
-extern error_t cli_safe_print(const uint8_t *str);
+extern error_t cli_print_async(const uint8_t *str);
 
 extern error_t cli_printf(const uint8_t *format, ...);
-extern error_t cli_safe_printf(const uint8_t *format, ...);
+extern error_t cli_printf_async(const uint8_t *format, ...);
+
+extern uint32_t cli_get_tx_dropped_bytes_qty(void);
+
+extern void cli_set_rx_raw_mode(bool en_dis);
+extern error_t cli_read(uint8_t *data, uint32_t *size, uint32_t max_size);
+
+extern error_t cli_cmd_help(uint32_t argc, const uint8_t **argv, cli_call_state_t state);
 
 
 #endif  // _CLI_H_
@@ -30,36 +30,55 @@ uint32_t crc_hw_clac(const crc_calc_settings_t *crc_settings, const uint8_t *dat
 }
 
 
+//  ***************************************************************************
+/// @brief  HW CRC calculation
+/// @note   Data is fed by 32-bit words (aligned part) and bytes (unaligned
+///         head and tail). CRC module clock is left enabled after first call.
+//  ***************************************************************************
 uint32_t crc_hw_continue_clac(const crc_calc_settings_t *crc_settings, uint32_t init, const uint8_t *data, uint32_t data_qty) {
-    uint8_t rev_in;
     uint32_t crc;
-    uint32_t crc_byte;
-    uint8_t *crc_dr_u8 = (uint8_t*)(&CRC->DR);     // need for 8 bit input data
-    // uint8_t *crc_dr_u16 = (uint16_t*)(&CRC->DR);     // need for 16 bit input data
-    // uint8_t *crc_dr_u32 = (uint32_t*)(&CRC->DR);     // need for 32 bit input data
+    volatile uint8_t *crc_dr_u8 = (volatile uint8_t*)(&CRC->DR);     // need for 8 bit input data
+    volatile uint32_t *crc_dr_u32 = (volatile uint32_t*)(&CRC->DR);  // need for 32 bit input data
+    const uint32_t *data_u32;
 
 
-    rev_in = 0;
-    if (crc_settings->refin) {
-        rev_in = 1;   // need for 8 bit input data
-        // rev_in = 2;   // need for 16 bit input data
-        // rev_in = 3;   // need for 32 bit input data
-    }    
-    RCC->AHBENR |= RCC_AHBENR_CRCEN;
+    if ((RCC->AHBENR & RCC_AHBENR_CRCEN) == 0) RCC->AHBENR |= RCC_AHBENR_CRCEN;
+    CRC->INIT = init;
+
+    // Bytes till word alignment. REV_IN: 0 - none, 1 - by byte, 3 - by word
     CRC->CR = (1 << CRC_CR_RESET_Pos) |
-              (rev_in << CRC_CR_REV_IN_Pos) |
+              ((crc_settings->refin ? 1 : 0) << CRC_CR_REV_IN_Pos) |
               (crc_settings->refout << CRC_CR_REV_OUT_Pos);
-    CRC->INIT = init;
+    while ((data_qty > 0) && ((uintptr_t)data & 0x03)) {
+        *crc_dr_u8 = *data++;
+        data_qty--;
+    }
 
+    // Words: first byte in memory should be processed first
+    data_u32 = (const uint32_t*)data;
+    if (crc_settings->refin) {
+        CRC->CR = (3 << CRC_CR_REV_IN_Pos) | (crc_settings->refout << CRC_CR_REV_OUT_Pos);
+        while (data_qty >= 4) {
+            *crc_dr_u32 = *data_u32++;
+            data_qty -= 4;
+        }
+        CRC->CR = (1 << CRC_CR_REV_IN_Pos) | (crc_settings->refout << CRC_CR_REV_OUT_Pos);
+    }
+    else {
+        while (data_qty >= 4) {
+            *crc_dr_u32 = __REV(*data_u32++);
+            data_qty -= 4;
+        }
+    }
 
-    for (crc_byte = 0; crc_byte < data_qty; crc_byte++) {
-        *crc_dr_u8 = data[crc_byte];
+    // Tail bytes
+    data = (const uint8_t*)data_u32;
+    while (data_qty > 0) {
+        *crc_dr_u8 = *data++;
+        data_qty--;
     }
     crc = CRC->DR;
 
-
-    RCC->AHBENR &= ~RCC_AHBENR_CRCEN;
-
     crc ^= crc_settings->xorout;
     return crc;
 }
@@ -0,0 +1,32 @@
+//  ***************************************************************************
+/// @file    le_bytes.c
+/// @note    Cortex-M0 faults on unaligned access, so records packed in byte
+///          buffers are read and written byte by byte
+//  ***************************************************************************
+#include "common/le_bytes.h"
+
+
+
+
+uint16_t le_get_u16(const uint8_t *src) {
+    return (uint16_t)src[0] | ((uint16_t)src[1] << 8);
+}
+
+
+uint32_t le_get_u32(const uint8_t *src) {
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+
+void le_put_u16(uint8_t *dst, uint16_t value) {
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8);
+}
+
+
+void le_put_u32(uint8_t *dst, uint32_t value) {
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8);
+    dst[2] = (uint8_t)(value >> 16);
+    dst[3] = (uint8_t)(value >> 24);
+}
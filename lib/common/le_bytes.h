@@ -0,0 +1,17 @@
+//  ***************************************************************************
+/// @file    le_bytes.h
+/// @brief   Little-endian values in byte buffers (unaligned access safe)
+//  ***************************************************************************
+#ifndef _LE_BYTES_H_
+#define _LE_BYTES_H_
+
+#include <stdint.h>
+
+
+extern uint16_t le_get_u16(const uint8_t *src);
+extern uint32_t le_get_u32(const uint8_t *src);
+extern void le_put_u16(uint8_t *dst, uint16_t value);
+extern void le_put_u32(uint8_t *dst, uint32_t value);
+
+
+#endif // _LE_BYTES_H_
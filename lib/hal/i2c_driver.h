@@ -12,7 +12,7 @@
 
 typedef struct {
     // Public
-    void         *peripheral;   // I2C for HW driver, TIM for SW driver
+    void         *peripheral;   // I2C for HW driver, not used by SW driver (delays by timebase)
     uint32_t     speed_hz;
     gpio_pin_t   scl_pin;
     gpio_pin_t   sda_pin;
@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include "common/mcu.h"
 #include "hal/systimer.h"
+#include "hal/timebase.h"
 #include "hal/sysclk.h"
 #include "hal/gpio.h"
 
@@ -19,7 +20,7 @@
 #define SCL_IS_UP     i2c_int->scl_port->IDR & (1 << i2c_int->scl_pin)
 #define SCL_IS_DOWN   !(i2c_int->scl_port->IDR & (1 << i2c_int->scl_pin))
 
-#define I2C_DELAY     i2c_clock_delay(i2c_int)
+#define I2C_DELAY     timebase_delay_ticks(i2c_int->delay_ticks)
 
 
 typedef struct {
@@ -28,7 +29,7 @@ typedef struct {
     uint32_t sda_pin;
     GPIO_TypeDef *scl_port;
     uint32_t scl_pin;
-    TIM_TypeDef* delay_tim;
+    uint16_t delay_ticks;
 } i2c_driver_soft_int_t;
 
 
@@ -39,7 +40,6 @@ static void i2c_stop(i2c_driver_soft_int_t *i2c_int);
 static bool i2c_write_byte(i2c_driver_soft_int_t *i2c_int, uint8_t data);
 static bool i2c_read_byte(i2c_driver_soft_int_t *i2c_int, uint8_t *recv_data, uint8_t is_ack);
 static error_t i2c_clock_delay_init(i2c_t *i2c);
-static void i2c_clock_delay(i2c_driver_soft_int_t *i2c_int);
 
 
 
@@ -61,7 +61,6 @@ error_t i2c_init(i2c_t *i2c) {
     i2c_int->sda_pin = (uint32_t)gpio_get_pin_n(i2c->sda_pin);
     i2c_int->scl_port = (GPIO_TypeDef*)gpio_get_peripheral(i2c->scl_pin);
     i2c_int->scl_pin = (uint32_t)gpio_get_pin_n(i2c->scl_pin);
-    i2c_int->delay_tim = (TIM_TypeDef*)i2c->peripheral;
 
     return i2c_clock_delay_init(i2c);
 }
@@ -354,26 +353,22 @@ static bool i2c_read_byte(i2c_driver_soft_int_t *i2c_int, uint8_t *recv_data, ui
 }
 
 
+//  ***************************************************************************
+/// @brief   Calculate quarter of SCL period in timebase ticks
+/// @param   i2c
+/// @return  @ref error_t
+/// @note    Timebase tick doesn't depend on clock configuration
+//  ***************************************************************************
 static error_t i2c_clock_delay_init(i2c_t *i2c) {
-    uint32_t timer_clock_hz, arr;
-
+    i2c_driver_soft_int_t *i2c_int;
+    uint32_t delay_ticks;
 
-    sysclk_enable_peripheral(i2c->peripheral);
-    ((TIM_TypeDef*)(i2c->peripheral))->CR1 = 1 << TIM_CR1_OPM_Pos;
-    ((TIM_TypeDef*)(i2c->peripheral))->PSC = 0;
 
-    sysclk_get_peripheral_freq(i2c->peripheral, &timer_clock_hz);
-    arr = timer_clock_hz / i2c->speed_hz;
-    arr = arr >> 2;   // /2
-    ((TIM_TypeDef*)(i2c->peripheral))->ARR = arr;
+    i2c_int = (i2c_driver_soft_int_t*)&i2c->int_stack;
+    delay_ticks = TIMEBASE_TICK_HZ / i2c->speed_hz;
+    delay_ticks = delay_ticks >> 2;   // /4
+    i2c_int->delay_ticks = (uint16_t)delay_ticks;
 
-    if (arr == 0) return E_INVALID_CONFIG;
+    if ((delay_ticks == 0) || (delay_ticks > UINT16_MAX)) return E_INVALID_CONFIG;
     return E_OK;
 }
-
-
-static void i2c_clock_delay(i2c_driver_soft_int_t *i2c_int) {
-    i2c_int->delay_tim->SR = 0;
-    i2c_int->delay_tim->CR1 = TIM_CR1_CEN;
-    while(!(i2c_int->delay_tim->SR & TIM_SR_UIF)) ;
-}
\ No newline at end of file
@@ -74,6 +74,33 @@ void int_adc_handler(void) {
 }
 
 
+void int_adc_set_clk_src(int_adc_clk_src_t clk_src) {
+    timer_t adc_timeout;
+    bool is_started;
+
+
+    if (((ADC1->CFGR2 & ADC_CFGR2_CKMODE_Msk) >> ADC_CFGR2_CKMODE_Pos) == clk_src) return;
+
+    // CKMODE can be changed only when ADC is disabled
+    is_started = (ADC1->CR & ADC_CR_ADSTART) != 0;
+    if (is_started) int_adc_stop_continuous_converts();
+    adc_timeout = timer_start_ms(ADC_TIMEOUT_MS);
+    while ((ADC1->CR & ADC_CR_ADSTART) != 0) {
+        if (timer_triggered(adc_timeout)) break;
+    }
+    int_adc_disable();
+    while ((ADC1->CR & ADC_CR_ADEN) != 0) {
+        if (timer_triggered(adc_timeout)) break;
+    }
+
+    ADC1->CFGR2 = clk_src << ADC_CFGR2_CKMODE_Pos;
+
+    // Samples of interrupted sequence are valid, only sequence position is lost
+    int_adc_enable();
+    if (is_started) int_adc_start_continuous_converts();
+}
+
+
 void int_adc_add_channel(int_adc_channel_t *int_adc_channel) {
     int32_t i;
 
@@ -48,6 +48,7 @@ typedef enum {
 
 extern void int_adc_init(int_adc_clk_src_t clk_src, int_adc_sample_rate_t smp_rate);
 extern void int_adc_handler(void);
+extern void int_adc_set_clk_src(int_adc_clk_src_t clk_src);
 
 extern void int_adc_add_channel(int_adc_channel_t *int_adc_channel);
 extern uint16_t int_adc_calc_vdda(uint16_t vref_data_raw);
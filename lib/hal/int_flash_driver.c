@@ -10,7 +10,7 @@
 static __ramfunc void flash_lock(void);
 static __ramfunc void flash_unlock(void);
 static __ramfunc bool flash_wait_operation_complete(void);
-static __ramfunc bool flash_write_word(uint32_t address, uint16_t word);
+static __ramfunc bool flash_wait_not_busy(void);
 
 
 
@@ -121,27 +121,46 @@ __ramfunc bool int_flash_driver_erase_page(uint32_t address) {
 /// @return true - success, false - fail
 /// @note   Memory must be cleared.
 /// @note   Address ans size must be even.
+/// @note   Burst: FLASH is unlocked once, only BSY is polled between halfwords,
+///         errors and written data are checked once for the whole run.
 //  ***************************************************************************
 __ramfunc bool int_flash_driver_write_bytes(uint32_t address, const uint8_t *buffer, uint32_t size) {
-    int32_t buff_index;
+    volatile uint16_t *flash_ptr = (volatile uint16_t*)address;
+    const volatile uint8_t *read_ptr = (const volatile uint8_t*)address;
+    uint32_t buff_index;
     uint16_t word;
+    bool result;
 
 
     if ((address & 0x01) || (size & 0x01)) return false;
-    
 
-    buff_index = 0;
-    while (size != 0) {
+    flash_unlock();
+    FLASH->SR |= FLASH_SR_EOP | FLASH_SR_WRPERR | FLASH_SR_PGERR;
+    FLASH->CR |= FLASH_CR_PG;
+
+    result = true;
+    for (buff_index = 0; buff_index < size; buff_index += 2) {
         word = buffer[buff_index + 1];
         word = word << 8;
         word |= buffer[buff_index];
-        size -= 2;
-        buff_index += 2;
 
-        if (!flash_write_word(address, word)) return false;
-        address += 2;
+        *flash_ptr++ = word;
+        if (!flash_wait_not_busy()) {
+            result = false;
+            break;
+        }
     }
 
+    FLASH->CR &= ~FLASH_CR_PG;
+    if (FLASH->SR & (FLASH_SR_WRPERR | FLASH_SR_PGERR)) result = false;
+    FLASH->SR |= FLASH_SR_EOP | FLASH_SR_WRPERR | FLASH_SR_PGERR;
+    flash_lock();
+    if (!result) return false;
+
+    // Check written data
+    for (buff_index = 0; buff_index < size; buff_index++) {
+        if (read_ptr[buff_index] != buffer[buff_index]) return false;
+    }
     return true;
 }
 
@@ -218,26 +237,15 @@ static __ramfunc bool flash_wait_operation_complete(void) {
 
 
 //  ***************************************************************************
-/// @brief  Write word to FLASH
-/// @param  address
-/// @param  word
-/// @return true - success, false - fail
+/// @brief  Wait FLASH isn't busy
+/// @param  none
+/// @return true - success, false - timeout
 //  ***************************************************************************
-static __ramfunc bool flash_write_word(uint32_t address, uint16_t word) {
-    bool result;
-
-
-    flash_unlock();
-    // Write word
-    FLASH->CR |= FLASH_CR_PG;
-    *((uint16_t*)address) = word;
-    // Wait operation complete
-    result = flash_wait_operation_complete();
-    FLASH->CR &= ~FLASH_CR_PG;
-    flash_lock();
-    if (!result) return false;
-    
-    // Check written data
-    uint16_t *read_word = (uint16_t*)address;
-    return *read_word == word;
+static __ramfunc bool flash_wait_not_busy(void) {
+    for (uint32_t i = 0; FLASH->SR & FLASH_SR_BSY; ++i) {
+        if (i > WAIT_LOOP_INTERATION_COUNT) {
+            return false;
+        }
+    }
+    return true;
 }
@@ -7,8 +7,11 @@
 #include "common/mcu.h"
 
 
+// 32-bit values: single load on Cortex-M0, so ISR can't tear them
 static uint32_t          core_freq_hz;
-static volatile uint64_t systime_ms = 0;
+static volatile uint32_t systime_ms = 0;
+static volatile uint32_t uptime_s = 0;
+static uint32_t          uptime_ms_counter = 0;
 static systimer_callback callback = NULL;
 
 
@@ -38,6 +41,11 @@ void systimer_init(void) {
 //  ***************************************************************************
 void systimer_handler(void) {
     systime_ms++;
+    uptime_ms_counter++;
+    if (uptime_ms_counter >= 1000) {
+        uptime_ms_counter = 0;
+        uptime_s++;
+    }
     if (callback != NULL) callback(systime_ms);
 }
 
@@ -59,7 +67,7 @@ void systimer_set_callback(systimer_callback callback_function) {
 /// @note   Granularity 1 ms, accuracy 1 ms
 //  ***************************************************************************
 void delay_ms(uint32_t ms) {
-    uint64_t start_time;
+    uint32_t start_time;
 
 
     start_time = systime_ms;
@@ -72,13 +80,24 @@ void delay_ms(uint32_t ms) {
 //  ***************************************************************************
 /// @brief  Get system timer value
 /// @param  none
-/// @return system timer value [ms]
+/// @return system timer value [ms], wraps around every ~49 days: use only
+///         differences of two values
 //  ***************************************************************************
-uint64_t get_time_ms(void) {
+uint32_t get_time_ms(void) {
     return systime_ms;
 }
 
 
+//  ***************************************************************************
+/// @brief  Get time since power-up
+/// @param  none
+/// @return uptime [s]
+//  ***************************************************************************
+uint32_t get_uptime_s(void) {
+    return uptime_s;
+}
+
+
 //  ***************************************************************************
 /// @brief  Start timer with specified time value
 /// @param  time_ms - time value in milliseconds
@@ -107,5 +126,5 @@ timer_t timer_restart_ms(timer_t timer, uint32_t time_ms) {
 /// @return triggered status
 //  ***************************************************************************
 bool timer_triggered(timer_t timer) {
-    return (systime_ms >= timer);
+    return ((int32_t)(systime_ms - timer) >= 0);
 }
@@ -9,15 +9,17 @@
 #include <stdbool.h>
 
 
-typedef uint64_t timer_t;
-typedef void (*systimer_callback)(uint64_t systime_ms);
+// Modular 32-bit ms ticks: timer interval should be less than 2^31 ms (~24 days)
+typedef uint32_t timer_t;
+typedef void (*systimer_callback)(uint32_t systime_ms);
 
 
 extern void systimer_init(void);
 extern void systimer_handler(void);
 extern void systimer_set_callback(systimer_callback callback_function);
 
-extern uint64_t get_time_ms(void);
+extern uint32_t get_time_ms(void);
+extern uint32_t get_uptime_s(void);
 
 extern void delay_ms(uint32_t ms);
 
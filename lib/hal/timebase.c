@@ -0,0 +1,158 @@
+//  ***************************************************************************
+/// @file    timebase.c
+//  ***************************************************************************
+#include "hal/timebase.h"
+#include "hal/sysclk.h"
+#include "common/mcu.h"
+
+
+#define TIMEBASE_US_PER_OVERFLOW    (0x10000UL / TIMEBASE_TICKS_PER_US)
+
+
+static volatile uint32_t overflows_qty = 0;
+
+
+
+
+//  ***************************************************************************
+/// @brief  Timebase init
+/// @param  none
+/// @return none
+/// @note   Should be called after every SYSCLK change: prescaler is
+///         recalculated, counter value is kept so time doesn't jump
+//  ***************************************************************************
+void timebase_init(void) {
+    uint32_t timer_clock_hz;
+    uint32_t primask;
+    uint16_t counter;
+
+
+    sysclk_enable_peripheral(TIMEBASE_TIM);
+    sysclk_get_peripheral_freq(TIMEBASE_TIM, &timer_clock_hz);
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    TIMEBASE_TIM->CR1 = TIM_CR1_URS;           // Only counter overflow sets update flag
+    TIMEBASE_TIM->ARR = 0xFFFF;
+    TIMEBASE_TIM->PSC = (timer_clock_hz / TIMEBASE_TICK_HZ) - 1;
+    counter = (uint16_t)TIMEBASE_TIM->CNT;
+    TIMEBASE_TIM->EGR = TIM_EGR_UG;            // Load prescaler now (resets counter)
+    TIMEBASE_TIM->CNT = counter;
+    TIMEBASE_TIM->DIER = TIM_DIER_UIE;
+    TIMEBASE_TIM->CR1 |= TIM_CR1_CEN;
+    __set_PRIMASK(primask);
+}
+
+
+//  ***************************************************************************
+/// @brief  Timebase interrupt handler (counter overflow)
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void timebase_handler(void) {
+    if (TIMEBASE_TIM->SR & TIM_SR_UIF) {
+        TIMEBASE_TIM->SR = ~TIM_SR_UIF;
+        overflows_qty++;
+    }
+}
+
+
+//  ***************************************************************************
+/// @brief  Get timebase value
+/// @param  none
+/// @return time [us], wraps around every ~71 minutes: use only differences
+///         of two values
+/// @note   Safe to call from interrupts and with interrupts disabled
+//  ***************************************************************************
+uint32_t get_time_us(void) {
+    uint32_t primask;
+    uint32_t overflows;
+    uint16_t counter;
+
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    overflows = overflows_qty;
+    counter = (uint16_t)TIMEBASE_TIM->CNT;
+    // Overflow isn't handled yet: counter value is after it
+    if ((TIMEBASE_TIM->SR & TIM_SR_UIF) && (counter < 0x8000)) overflows++;
+    __set_PRIMASK(primask);
+
+    return (overflows * TIMEBASE_US_PER_OVERFLOW) + (counter / TIMEBASE_TICKS_PER_US);
+}
+
+
+//  ***************************************************************************
+/// @brief  Provide us-resolution delay
+/// @param  us
+/// @return none
+/// @note   Granularity 1 us, accuracy 1 us
+//  ***************************************************************************
+void delay_us(uint32_t us) {
+    uint32_t start_time;
+
+
+    start_time = get_time_us();
+    while ((get_time_us() - start_time) < us) {
+        asm("nop");
+    }
+}
+
+
+//  ***************************************************************************
+/// @brief  Get raw counter value
+/// @param  none
+/// @return ticks [1 / TIMEBASE_TICK_HZ], wraps around every 65536 ticks
+/// @note   For short busy-waits, doesn't touch interrupts
+//  ***************************************************************************
+uint16_t timebase_get_ticks(void) {
+    return (uint16_t)TIMEBASE_TIM->CNT;
+}
+
+
+//  ***************************************************************************
+/// @brief  Provide tick-resolution delay
+/// @param  ticks - delay [1 / TIMEBASE_TICK_HZ], less than 65536
+/// @return none
+/// @note   Accuracy 1 tick
+//  ***************************************************************************
+void timebase_delay_ticks(uint16_t ticks) {
+    uint16_t start_ticks;
+
+
+    start_ticks = (uint16_t)TIMEBASE_TIM->CNT;
+    while ((uint16_t)((uint16_t)TIMEBASE_TIM->CNT - start_ticks) < ticks) ;
+}
+
+
+//  ***************************************************************************
+/// @brief  Reset interval statistics and start new interval
+/// @param  capture
+/// @return none
+//  ***************************************************************************
+void timebase_capture_reset(timebase_capture_t *capture) {
+    capture->last_us = get_time_us();
+    capture->min_period_us = UINT32_MAX;
+    capture->max_period_us = 0;
+    capture->periods_qty = 0;
+}
+
+
+//  ***************************************************************************
+/// @brief  Capture timestamp and update interval statistics
+/// @param  capture
+/// @return period since previous capture (or reset) [us]
+//  ***************************************************************************
+uint32_t timebase_capture(timebase_capture_t *capture) {
+    uint32_t time_us, period_us;
+
+
+    time_us = get_time_us();
+    period_us = time_us - capture->last_us;
+    capture->last_us = time_us;
+
+    if (period_us < capture->min_period_us) capture->min_period_us = period_us;
+    if (period_us > capture->max_period_us) capture->max_period_us = period_us;
+    capture->periods_qty++;
+    return period_us;
+}
@@ -0,0 +1,40 @@
+//  ***************************************************************************
+/// @file    timebase.h
+/// @brief   Free-running microsecond timebase on hardware timer
+//  ***************************************************************************
+#ifndef _TIMEBASE_H_
+#define _TIMEBASE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lib_config.h"
+
+
+// Counter ticks at TIMEBASE_TICKS_PER_US MHz (timer clock should be a multiple),
+// 16-bit counter is extended by overflow interrupt
+#define TIMEBASE_TICK_HZ        (TIMEBASE_TICKS_PER_US * 1'000'000UL)
+
+
+// Interval statistics between successive captures
+typedef struct {
+    uint32_t last_us;
+    uint32_t min_period_us;
+    uint32_t max_period_us;
+    uint32_t periods_qty;
+} timebase_capture_t;
+
+
+extern void timebase_init(void);
+extern void timebase_handler(void);
+
+extern uint32_t get_time_us(void);
+extern void delay_us(uint32_t us);
+
+extern uint16_t timebase_get_ticks(void);
+extern void timebase_delay_ticks(uint16_t ticks);
+
+extern void timebase_capture_reset(timebase_capture_t *capture);
+extern uint32_t timebase_capture(timebase_capture_t *capture);
+
+
+#endif  // _TIMEBASE_H_
@@ -0,0 +1,152 @@
+//  ***************************************************************************
+/// @file    timer_wheel.c
+/// @note    Timers are hashed to TIMER_WHEEL_SLOTS_QTY slots by expiration
+///          tick. Process visits one slot per elapsed tick and fires only the
+///          timers expiring at this tick, so modules don't poll their timers.
+///          Callbacks are called from @ref timer_wheel_process (main loop),
+///          not from interrupt.
+//  ***************************************************************************
+#include "hal/timer_wheel.h"
+#include <stdlib.h>
+
+
+#define TIMER_WHEEL_SLOT_MASK   (TIMER_WHEEL_SLOTS_QTY - 1)
+
+#if ((TIMER_WHEEL_SLOTS_QTY & TIMER_WHEEL_SLOT_MASK) != 0)
+#error "TIMER_WHEEL_SLOTS_QTY should be power of 2"
+#endif
+
+
+static timer_wheel_timer_t *wheel_slots[TIMER_WHEEL_SLOTS_QTY];
+static timer_t wheel_last_tick_ms;
+
+
+static void wheel_insert(timer_wheel_timer_t *timer);
+static void wheel_remove(timer_wheel_timer_t *timer);
+static timer_wheel_timer_t *wheel_get_expired(timer_t tick_ms);
+
+
+
+
+void timer_wheel_init(void) {
+    uint32_t i;
+
+
+    for (i = 0; i < TIMER_WHEEL_SLOTS_QTY; i++) wheel_slots[i] = NULL;
+    wheel_last_tick_ms = get_time_ms();
+}
+
+
+//  ***************************************************************************
+/// @brief  Fire expired timers
+/// @param  none
+/// @return none
+/// @note   Ticks missed by slow main loop pass are caught up one by one.
+///         Callback can stop or restart any timer, which relinks slot list,
+///         so expired timer is searched from the slot head after every call.
+//  ***************************************************************************
+void timer_wheel_process(void) {
+    timer_wheel_timer_t *timer;
+    timer_t now_ms;
+
+
+    now_ms = get_time_ms();
+    while (wheel_last_tick_ms != now_ms) {
+        wheel_last_tick_ms++;
+        while ((timer = wheel_get_expired(wheel_last_tick_ms)) != NULL) {
+            wheel_remove(timer);
+            if (timer->period_ms > 0) {
+                timer->expire_ms = timer_restart_ms(timer->expire_ms, timer->period_ms);
+                wheel_insert(timer);
+            }
+            timer->callback(timer->arg);
+        }
+    }
+}
+
+
+//  ***************************************************************************
+/// @brief  Start or restart timer
+/// @param  timer - pointer, can't be NULL
+/// @param  time_ms - time to the first expiration, 0 - the next tick
+/// @param  period_ms - period of the next expirations, 0 - one-shot timer
+/// @param  callback - pointer, can't be NULL
+/// @param  arg - callback argument, can be NULL
+/// @return none
+/// @note   Timer can be restarted from its callback
+//  ***************************************************************************
+void timer_wheel_start(timer_wheel_timer_t *timer, uint32_t time_ms, uint32_t period_ms, timer_wheel_callback callback, void *arg) {
+    if (timer->is_active) wheel_remove(timer);
+
+    if (time_ms == 0) time_ms = 1;
+    timer->expire_ms = timer_start_ms(time_ms);
+    timer->period_ms = period_ms;
+    timer->callback = callback;
+    timer->arg = arg;
+    wheel_insert(timer);
+}
+
+
+//  ***************************************************************************
+/// @brief  Restart timer relative to its last expiration
+/// @param  timer - pointer, can't be NULL, should be started before
+/// @param  time_ms - time from the last expiration
+/// @return none
+/// @note   Useful to chain one-shot phases from callback without time gaps,
+///         see @ref timer_restart_ms
+//  ***************************************************************************
+void timer_wheel_restart(timer_wheel_timer_t *timer, uint32_t time_ms) {
+    if (timer->is_active) wheel_remove(timer);
+
+    timer->expire_ms = timer_restart_ms(timer->expire_ms, time_ms);
+    wheel_insert(timer);
+}
+
+
+void timer_wheel_stop(timer_wheel_timer_t *timer) {
+    if (timer->is_active) wheel_remove(timer);
+}
+
+
+bool timer_wheel_is_active(const timer_wheel_timer_t *timer) {
+    return timer->is_active;
+}
+
+
+
+
+static void wheel_insert(timer_wheel_timer_t *timer) {
+    timer_wheel_timer_t **slot;
+
+
+    slot = &wheel_slots[timer->expire_ms & TIMER_WHEEL_SLOT_MASK];
+    timer->next = *slot;
+    *slot = timer;
+    timer->is_active = true;
+}
+
+
+static void wheel_remove(timer_wheel_timer_t *timer) {
+    timer_wheel_timer_t **link;
+
+
+    for (link = &wheel_slots[timer->expire_ms & TIMER_WHEEL_SLOT_MASK]; *link != NULL; link = &(*link)->next) {
+        if (*link == timer) {
+            *link = timer->next;
+            break;
+        }
+    }
+    timer->is_active = false;
+}
+
+
+static timer_wheel_timer_t *wheel_get_expired(timer_t tick_ms) {
+    timer_wheel_timer_t *timer;
+
+
+    // Slot also keeps timers of the next wheel turns
+    for (timer = wheel_slots[tick_ms & TIMER_WHEEL_SLOT_MASK]; timer != NULL; timer = timer->next) {
+        if (timer->expire_ms == tick_ms) return timer;
+    }
+    return NULL;
+}
@@ -0,0 +1,36 @@
+//  ***************************************************************************
+/// @file    timer_wheel.h
+/// @brief   Hashed timer wheel with callbacks on systimer ticks
+//  ***************************************************************************
+#ifndef _TIMER_WHEEL_H_
+#define _TIMER_WHEEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal/systimer.h"
+#include "lib_config.h"
+
+
+typedef void (*timer_wheel_callback)(void *arg);
+
+// Timer memory is owned by caller, timer should be static or global
+typedef struct timer_wheel_timer_s {
+    struct timer_wheel_timer_s *next;
+    timer_t expire_ms;
+    uint32_t period_ms;             // 0 - one-shot timer
+    timer_wheel_callback callback;
+    void *arg;
+    bool is_active;
+} timer_wheel_timer_t;
+
+
+extern void timer_wheel_init(void);
+extern void timer_wheel_process(void);
+
+extern void timer_wheel_start(timer_wheel_timer_t *timer, uint32_t time_ms, uint32_t period_ms, timer_wheel_callback callback, void *arg);
+extern void timer_wheel_restart(timer_wheel_timer_t *timer, uint32_t time_ms);
+extern void timer_wheel_stop(timer_wheel_timer_t *timer);
+extern bool timer_wheel_is_active(const timer_wheel_timer_t *timer);
+
+
+#endif  // _TIMER_WHEEL_H_
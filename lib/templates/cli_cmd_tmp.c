@@ -26,7 +26,18 @@ static bool pars_string_to_s32_and_check(const uint8_t *str, int32_t *digit, int
 static bool pars_string_to_u32_and_check(const uint8_t *str, uint32_t *digit, uint32_t min, uint32_t max);
 
 
+// Sorted by name (strcmp order) for binary search
 const cli_cmd_t cli_cmds[] = {
+    {
+        .name = "clidbg",
+        .usage = "en",
+        .func = cli_cmd_clidbg
+    },
+    {
+        .name = "help",
+        .usage = "",
+        .func = cli_cmd_help
+    },
     {
         .name = "reboot",
         .usage = "",
@@ -38,14 +49,9 @@ const cli_cmd_t cli_cmds[] = {
         .func = cli_cmd_rr
     },
     {
-        .name = "wr",
-        .usage = "ADDR VAL",
-        .func = cli_cmd_wr
-    },
-    {
-        .name = "clidbg",
-        .usage = "en",
-        .func = cli_cmd_clidbg
+        .name = "tconf",
+        .usage = "[ACT_MS DELAY_MS HYST_ON_C HYST_OFF_C]",
+        .func = cli_cmd_tconf
     },
     {
         .name = "tlog",
@@ -53,10 +59,10 @@ const cli_cmd_t cli_cmds[] = {
         .func = cli_cmd_tlog
     },
     {
-        .name = "tconf",
-        .usage = "[ACT_MS DELAY_MS HYST_ON_C HYST_OFF_C]",
-        .func = cli_cmd_tconf
-    }
+        .name = "wr",
+        .usage = "ADDR VAL",
+        .func = cli_cmd_wr
+    },
 };
 
 
@@ -89,13 +95,8 @@ static error_t cli_cmd_rr(uint32_t argc, const uint8_t **argv, cli_call_state_t
     if (argc != 2) return E_INVALID_ARG;
     if (!pars_string_to_u32_and_check(argv[1], &addr, 0, RG_MAX_REG_ADDR)) return E_INVALID_ARG;
 
-    if (regs_read_reg(addr, &reg_value)) {
-        cli_safe_printf("%d", reg_value);
-    }
-    else {
-        return E_FAILED;
-    }
-    return E_OK;
+    if (!regs_read_reg(addr, &reg_value)) return E_FAILED;
+    return cli_printf_async("%d", reg_value);
 }
 
 
@@ -133,14 +134,14 @@ static error_t cli_cmd_tlog(uint32_t argc, const uint8_t **argv, cli_call_state_
         if (argc != 2) return E_INVALID_ARG;
         if (!pars_string_to_u32_and_check(argv[1], &log_period_ms, 0, 0)) return E_INVALID_ARG;
 
-        cli_safe_printf("Temp_c; Heat_en");
+        cli_printf("Temp_c; Heat_en");
         log_timer = timer_start_ms(log_period_ms);
         return E_ASYNC_WAIT;
     }
     if (state == CLI_CALL_REPEATED) {
         if (timer_triggered(log_timer)) {
             log_timer = timer_restart_ms(log_timer, log_period_ms);
-            cli_safe_printf("\r\n%d; %d", heater_current_temperature_c, is_heater_pin_en);
+            cli_printf("\r\n%d; %d", heater_current_temperature_c, is_heater_pin_en);
             return E_ASYNC_WAIT;
         }
 
@@ -158,8 +159,7 @@ static error_t cli_cmd_tconf(uint32_t argc, const uint8_t **argv, cli_call_state
 
 
     if (argc == 1) {
-        cli_safe_printf("act_ms = %d\r\ndel_ms = %d\r\nhon_c = %d\r\nnoff_c = %d", heater_active_time_ms, heater_delay_time_ms, heater_hist_on_c, heater_hist_off_c);
-        return E_OK;
+        return cli_printf_async("act_ms = %d\r\ndel_ms = %d\r\nhon_c = %d\r\nnoff_c = %d", heater_active_time_ms, heater_delay_time_ms, heater_hist_on_c, heater_hist_off_c);
     }
     else if (argc == 5) {
         if (!pars_string_to_u32_and_check(argv[1], &active_time_ms, 0, 0)) return E_INVALID_ARG;
@@ -1,190 +1,187 @@
-import serial
-import time
+import json
+import struct
+import sys
+import regs_map
 
 
 port = "COM10"
 baudrate = 115200
 
 
-profiles = [
-    {
-        "name": "drying_water",
-        "stages": [
-            {
-                "temperature_c" : 60,
-                "duration_s": 240,
-                "fun_period_s": 60,
-                "fun_duty_cycle_pct": 50
-            },
-            {
-                "temperature_c" : 0,
-                "duration_s": 0,
-                "fun_period_s": 0,
-                "fun_duty_cycle_pct": 0
-            },
-            {
-                "temperature_c" : 0,
-                "duration_s": 0,
-                "fun_period_s": 0,
-                "fun_duty_cycle_pct": 0
-            }
-        ]
-    },
-    {
-        "name": "mask_begin",
-        "stages": [
-            {
-                "temperature_c" : 70,
-                "duration_s": 300,
-                "fun_period_s": 0,
-                "fun_duty_cycle_pct": 0
-            },
-            {
-                "temperature_c" : 70,
-                "duration_s": 600,
-                "fun_period_s": 120,
-                "fun_duty_cycle_pct": 10
-            },
-            {
-                "temperature_c" : 0,
-                "duration_s": 0,
-                "fun_period_s": 0,
-                "fun_duty_cycle_pct": 0
-            }
-        ]
-    },
-    {
-        "name": "mask_end",
-        "stages": [
-            {
-                "temperature_c" : 140,
-                "duration_s": 600,
-                "fun_period_s": 0,
-                "fun_duty_cycle_pct": 0
-            },
-            {
-                "temperature_c" : 140,
-                "duration_s": 600,
-                "fun_period_s": 120,
-                "fun_duty_cycle_pct": 10
-            },
-            {
-                "temperature_c" : 140,
-                "duration_s": 600,
-                "fun_period_s": 0,
-                "fun_duty_cycle_pct": 0
-            }
-        ]
-    },
-    {
-        "name": "",
-        "stages": [
-            {
-                "temperature_c" : 0,
-                "duration_s": 0,
-                "fun_period_s": 0,
-                "fun_duty_cycle_pct": 0
-            },
-            {
-                "temperature_c" : 0,
-                "duration_s": 0,
-                "fun_period_s": 0,
-                "fun_duty_cycle_pct": 0
-            },
-            {
-                "temperature_c" : 0,
-                "duration_s": 0,
-                "fun_period_s": 0,
-                "fun_duty_cycle_pct": 0
-            }
-        ]
-    },
-]
-
-
-
-def wait_prompt():
+# Profiles format and limits: generated registers map (see registers.yaml), FLASH_x in src/flash.h
+PROFILES_AREA_SIZE = regs_map.RG_FLASH_RW_REG_PROFILES_AREA_SIZE
+PROFILES_QTY = regs_map.RG_PROFILES_QTY
+PROFILE_NAME_SIZE = regs_map.RG_PROFILE_NAME_SIZE
+PROFILE_STAGES_QTY = regs_map.RG_PROFILE_STAGES_QTY
+STAGE_FLAG_FUN = regs_map.RG_PROFILE_STAGE_FLAG_FUN
+HEATER_MAX_TEMP_C = 200
+FUN_DUTY_CYCLE_MAX_PCT = 100
+
+FLASH_SIZE = 1024
+FLASH_SEQ_ADDR = FLASH_SIZE - 8
+FLASH_CRC32_ADDR = FLASH_SIZE - 4
+FLASH_SEQ_ERASED = 0xFFFFFFFF
+
+
+
+def crc32_posix(data:bytes) -> int:
+    # crc_hw_32_posix: poly 0x04C11DB7, init 0, no reflection, xorout 0xFFFFFFFF
+    crc = 0
+    for byte in data:
+        crc ^= byte << 24
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x04C11DB7) if (crc & 0x80000000) else (crc << 1)
+            crc &= 0xFFFFFFFF
+    return crc ^ 0xFFFFFFFF
+
+
+def load_profiles(file_name:str) -> list:
+    with open(file_name, "r") as f:
+        if file_name.endswith((".yaml", ".yml")):
+            import yaml
+            return yaml.safe_load(f)
+        return json.load(f)
+
+
+def validate_profiles(profiles:list):
+    # Same limits as profile_validate() in src/profiles.c, device doesn't start invalid profiles
+    if len(profiles) > PROFILES_QTY:
+        raise ValueError("too many profiles: " + str(len(profiles)))
+    for profile in profiles:
+        name = profile["name"]
+        if not (1 <= len(name.encode("ascii")) <= PROFILE_NAME_SIZE):
+            raise ValueError(name + ": name should be 1.." + str(PROFILE_NAME_SIZE) + " ASCII symbols")
+        if not (1 <= len(profile["stages"]) <= PROFILE_STAGES_QTY):
+            raise ValueError(name + ": stages qty should be 1.." + str(PROFILE_STAGES_QTY))
+        for i, stage in enumerate(profile["stages"]):
+            where = name + ", stage " + str(i) + ": "
+            if not (0 <= stage["temperature_c"] <= HEATER_MAX_TEMP_C):
+                raise ValueError(where + "temperature_c should be 0.." + str(HEATER_MAX_TEMP_C))
+            if not (1 <= stage["duration_s"] <= 0xFFFF):
+                raise ValueError(where + "duration_s should be 1..65535")
+            if not (0 <= stage.get("fun_period_s", 0) <= 0xFFFF):
+                raise ValueError(where + "fun_period_s should be 0..65535")
+            if not (0 <= stage.get("fun_duty_cycle_pct", 0) <= FUN_DUTY_CYCLE_MAX_PCT):
+                raise ValueError(where + "fun_duty_cycle_pct should be 0.." + str(FUN_DUTY_CYCLE_MAX_PCT))
+
+
+def encode_profiles(profiles:list) -> bytes:
+    # Variable-length format, see RG_PROFILE_x in registers.yaml
+    data = bytearray()
+    for profile in profiles:
+        name = profile["name"].encode("ascii")
+        data += bytes([len(name), len(profile["stages"])]) + name
+        for stage in profile["stages"]:
+            is_fun = stage.get("fun_period_s", 0) > 0
+            data += struct.pack("<BBH", STAGE_FLAG_FUN if is_fun else 0, stage["temperature_c"], stage["duration_s"])
+            if is_fun:
+                data += struct.pack("<HB", stage["fun_period_s"], stage["fun_duty_cycle_pct"])
+    if len(data) > PROFILES_AREA_SIZE:
+        raise ValueError("profiles size " + str(len(data)) + " > " + str(PROFILES_AREA_SIZE) + " bytes")
+    return bytes(data)
+
+
+def decode_profiles(data:bytes) -> list:
+    # Mirrors profile_parse() in src/profiles.c: the first broken or empty header ends the list
+    profiles = []
+    offset = 0
+    while (len(profiles) < PROFILES_QTY) and (offset + 2 <= PROFILES_AREA_SIZE):
+        name_size, stages_qty = data[offset], data[offset + 1]
+        if not (1 <= name_size <= PROFILE_NAME_SIZE) or not (1 <= stages_qty <= PROFILE_STAGES_QTY):
+            break
+        offset += 2
+        profile = {"name": data[offset:offset + name_size].decode("ascii", "replace"), "stages": []}
+        offset += name_size
+        for _ in range(stages_qty):
+            flags, temperature_c, duration_s = struct.unpack_from("<BBH", data, offset)
+            offset += 4
+            stage = {"temperature_c": temperature_c, "duration_s": duration_s, "fun_period_s": 0, "fun_duty_cycle_pct": 0}
+            if flags & STAGE_FLAG_FUN:
+                stage["fun_period_s"], stage["fun_duty_cycle_pct"] = struct.unpack_from("<HB", data, offset)
+                offset += 3
+            profile["stages"].append(stage)
+        if offset > PROFILES_AREA_SIZE:
+            break
+        profiles.append(profile)
+    return profiles
+
+
+def build_image(profiles_data:bytes) -> bytes:
+    # Whole config page as device writes it, erased sequence number counts as 0
+    image = bytearray(b"\xFF" * FLASH_SIZE)
+    image[0:len(profiles_data)] = profiles_data
+    struct.pack_into("<I", image, FLASH_SEQ_ADDR, FLASH_SEQ_ERASED)
+    struct.pack_into("<I", image, FLASH_CRC32_ADDR, crc32_posix(image[0:FLASH_CRC32_ADDR]))
+    return bytes(image)
+
+
+def check_image(image:bytes):
+    if len(image) != FLASH_SIZE:
+        raise ValueError("image size should be " + str(FLASH_SIZE) + " bytes")
+    if crc32_posix(image[0:FLASH_CRC32_ADDR]) != struct.unpack_from("<I", image, FLASH_CRC32_ADDR)[0]:
+        raise ValueError("image CRC error")
+
+
+def open_port():
+    import serial
+    ser = serial.Serial(port, baudrate=baudrate)
+    ser.timeout = 2
+    ser.write(b"\r")
     ser.read_until(b">", 100)
+    return ser
 
 
-def write_reg_u16(address:int, data:int):
-    message = "wr " + str(address) + " " + str(data) + "\x0D"
-    ser.write(message.encode())
-    wait_prompt()
+def upload_image(image:bytes):
+    ser = open_port()
+    ser.write(b"fimg wr\r")
+    ser.read_until(b"\r\n", 100)   # echo, device is in raw mode after it
+    ser.write(image)
+    reply = ser.read_until(b">", 100)
+    ser.close()
+    if b"Failed!" in reply:
+        raise RuntimeError("device rejected image")
+
+
+def download_image() -> bytes:
+    ser = open_port()
+    ser.write(b"fimg rd\r")
+    ser.read_until(b"\r\n", 100)
+    image = ser.read(FLASH_SIZE)
+    ser.read_until(b">", 100)
+    ser.close()
+    return image
 
 
-def write_reg_u32(address:int, data:int):
-    reg_lo = data & 0x0000FFFF
-    reg_hi = data >> 8
-    write_reg_u16(address, reg_lo)
-    write_reg_u16((address + 1), reg_hi)
 
 
-def write_reg_string(address:int, data:str):
-    name_symb_in_reg = 0
-    regs_values_qty = 0
-    regs_values:int = []
+if __name__ == "__main__":
+    # Usage:
+    #   prof_scr.py upload PROFILES.json|yaml   - validate, build page image and write it to device
+    #   prof_scr.py image PROFILES.json|yaml OUT.bin - validate and build page image only
+    #   prof_scr.py dump OUT.json [IN.bin]      - read profiles from device (or image file) to JSON
+    if (len(sys.argv) < 3) or (sys.argv[1] not in ("upload", "image", "dump")):
+        print("Usage: prof_scr.py upload|image|dump ...")
+        sys.exit(1)
 
-    for symb in data:
-        if name_symb_in_reg == 0:
-            regs_values.append(0)
-            regs_values_qty += 1
-            regs_values[regs_values_qty - 1] = ord(symb)
+    if sys.argv[1] in ("upload", "image"):
+        profiles = load_profiles(sys.argv[2])
+        validate_profiles(profiles)
+        image = build_image(encode_profiles(profiles))
+        if sys.argv[1] == "image":
+            with open(sys.argv[3], "wb") as f:
+                f.write(image)
         else:
-            regs_values[regs_values_qty - 1] |= ord(symb) << 8
-        name_symb_in_reg += 1
-        if name_symb_in_reg >= 2:
-            name_symb_in_reg = 0
-    if name_symb_in_reg == 1:
-        regs_values[regs_values_qty - 1] |= '\0' << 8
-
-    for reg_value in regs_values:
-        write_reg_u16(address, reg_value)
-        address += 1
-
-
-
-
-ser = serial.Serial(port, baudrate=baudrate)
-ser.timeout = 2
-print("Start\r\n")
-ser.write(b"\r")
-wait_prompt()
-print("Flash erase...\r\n")
-ser.write(b"wr 7 2\r")   # Flash erase
-wait_prompt()
-time.sleep(2.0)
-reg_addr = 8
-print("Write profiles...\r\n")
-for profile in profiles:
-    name = profile["name"]
-    while len(name) < 18:
-        name += '\0'
-    write_reg_string(reg_addr, name)
-    reg_addr += 9
-
-    for stage in profile["stages"]:
-        write_reg_u16(reg_addr, stage["temperature_c"])
-        reg_addr += 1
-        write_reg_u32(reg_addr, stage["duration_s"])
-        reg_addr += 2
-        write_reg_u32(reg_addr, stage["fun_period_s"])
-        reg_addr += 2
-        write_reg_u16(reg_addr, stage["fun_duty_cycle_pct"])
-        reg_addr += 1
-
-
-time.sleep(2.0)
-print("Update CRC...\r\n")
-ser.write(b"wr 7 3\r")   # Update CRC
-time.sleep(2.0)
-print("Reboot...\r\n")
-ser.write(b"wr 7 1\r")   # Reboot
-
-print("Done!\r\n")
-ser.close()
-
-
-
-
-    
\ No newline at end of file
+            print("Write image...\r\n")
+            upload_image(image)
+    else:
+        if len(sys.argv) > 3:
+            with open(sys.argv[3], "rb") as f:
+                image = f.read()
+        else:
+            print("Read image...\r\n")
+            image = download_image()
+        check_image(image)
+        with open(sys.argv[2], "w") as f:
+            json.dump(decode_profiles(image), f, indent=4)
+
+    print("Done!\r\n")
@@ -0,0 +1,212 @@
+import sys
+import yaml
+
+
+schema_file_name = "registers.yaml"
+c_header_file_name = "src/registers_map.h"
+c_source_file_name = "src/registers_map.c"
+py_file_name = "regs_map.py"
+
+
+STORAGES = {"ram": "RAM", "flash": "FLASH", "ee": "EE"}
+ACCESSES = {"ro": "RO", "rw": "RW"}
+TYPES = {"u16": "U16", "bytes": "BYTES"}
+DEFINE_WIDTH = 45
+
+
+
+def build_map(schema:dict) -> dict:
+    # Assign addresses, check overlaps and ranges
+    groups = []
+    regs = []
+    address = 0
+    for group in schema["groups"]:
+        if group["storage"] not in STORAGES or group["access"] not in ACCESSES:
+            raise ValueError(group["name"] + ": unknown storage or access")
+        if "address" in group:
+            if group["address"] < address:
+                raise ValueError(group["name"] + ": overlaps previous group")
+            address = group["address"]
+        first_address = address
+        for reg in group["registers"]:
+            reg_type = reg.get("type", "u16")
+            if reg_type not in TYPES:
+                raise ValueError(reg["name"] + ": unknown type")
+            size = reg["size"] if reg_type == "bytes" else 2
+            qty = (size + 1) // 2
+            reg_min, reg_max = (reg.get("min", 0), reg.get("max", 0xFFFF)) if reg_type == "u16" else (0, 0xFFFF)
+            if not (0 <= reg_min <= reg_max <= 0xFFFF):
+                raise ValueError(reg["name"] + ": wrong range")
+            regs.append({
+                "name": "RG_" + group["name"] + "_REG_" + reg["name"],
+                "group": group["name"],
+                "address": address,
+                "qty": qty,
+                "size": size,
+                "type": reg_type,
+                "storage": group["storage"],
+                "access": group["access"],
+                "min": reg_min,
+                "max": reg_max,
+                "is_max_set": (reg_type == "u16") and ("max" in reg)
+            })
+            address += qty
+        groups.append({"name": group["name"], "storage": group["storage"], "address": first_address, "qty": address - first_address})
+
+    # Storage address: RAM - registers_ram index, FLASH - byte address, EE - EEPROM variable ID.
+    # Groups of one storage are packed one after another in storage even if
+    # their addresses aren't contiguous (fixed address groups).
+    storages = {}
+    for storage in STORAGES:
+        storage_groups = [group for group in groups if group["storage"] == storage]
+        if len(storage_groups) == 0:
+            continue
+        offset = 0
+        for group in storage_groups:
+            group["storage_offset"] = offset
+            offset += group["qty"]
+        storages[storage] = {"address": storage_groups[0]["address"], "qty": offset}
+    groups_by_name = {group["name"]: group for group in groups}
+    for reg in regs:
+        group = groups_by_name[reg["group"]]
+        offset = group["storage_offset"] + reg["address"] - group["address"]
+        reg["storage_address"] = offset * 2 if reg["storage"] == "flash" else offset
+    if storages["ram"]["address"] != 0:
+        raise ValueError("RAM registers should start from 0")
+
+    return {"groups": groups, "regs": regs, "storages": storages, "max_address": address - 1}
+
+
+def define(name:str, value, comment:str = None) -> str:
+    line = "#define " + name.ljust(DEFINE_WIDTH - 1) + " (" + str(value) + ")"
+    if comment:
+        line = line.ljust(DEFINE_WIDTH + 16) + "// " + comment
+    return line + "\n"
+
+
+def gen_c_header(schema:dict, regs_map:dict) -> str:
+    out = "//  ***************************************************************************\n"
+    out += "/// @file    registers_map.h\n"
+    out += "/// @brief   Registers map\n"
+    out += "/// @note    Generated by regs_gen.py from registers.yaml, don't edit\n"
+    out += "//  ***************************************************************************\n"
+    out += "#ifndef _REGISTERS_MAP_H_\n#define _REGISTERS_MAP_H_\n\n\n"
+
+    out += define("RG_MEMORY_MAP_VERSION", "0x%04X" % schema["memory_map_version"])
+    out += "\n"
+    for group in regs_map["groups"]:
+        out += define("RG_" + group["name"] + "_REGS_ADDR_OFFSET", group["address"])
+        out += define("RG_" + group["name"] + "_REGS_QTY", group["qty"])
+    for storage, value in regs_map["storages"].items():
+        name = STORAGES[storage]
+        if any(group["name"] == name for group in regs_map["groups"]):
+            continue
+        out += define("RG_" + name + "_REGS_ADDR_OFFSET", value["address"])
+        out += define("RG_" + name + "_REGS_QTY", value["qty"])
+    out += define("RG_MAX_REG_ADDR", regs_map["max_address"], "the last register")
+    out += define("RG_DESCRIPTORS_QTY", len(regs_map["regs"]))
+    out += "\n"
+
+    group_name = None
+    for reg in regs_map["regs"]:
+        if (group_name is not None) and (reg["group"] != group_name):
+            out += "\n"
+        group_name = reg["group"]
+        out += define(reg["name"], reg["address"])
+        if reg["type"] == "bytes":
+            out += define(reg["name"] + "_SIZE", reg["size"], "bytes")
+        if reg["is_max_set"]:
+            out += define(reg["name"] + "_MAX", reg["max"])
+        if reg["storage"] == "ram":
+            out += define(reg["name"] + "_RAM_INDEX", reg["storage_address"], "registers_ram[] index")
+    out += "\n\n"
+
+    for cmd in schema["commands"]:
+        out += define("RG_CMD_" + cmd["name"], cmd["value"], cmd.get("comment"))
+    out += "\n"
+    for item in schema["profile_format"]:
+        value = ("0x%02X" % item["value"]) if item["name"].startswith("STAGE_FLAG_") else item["value"]
+        out += define("RG_PROFILE_" + item["name"], value, item.get("comment"))
+    out += define("RG_PROFILES_QTY", schema["profiles_qty"], "max")
+
+    out += "\n\n#endif   // _REGISTERS_MAP_H_\n"
+    return out
+
+
+def gen_c_source(regs_map:dict) -> str:
+    out = "//  ***************************************************************************\n"
+    out += "/// @file    registers_map.c\n"
+    out += "/// @note    Generated by regs_gen.py from registers.yaml, don't edit\n"
+    out += "//  ***************************************************************************\n"
+    out += "#include \"registers.h\"\n\n\n"
+    out += "// Sorted by address\n"
+    out += "const regs_descriptor_t regs_descriptors[RG_DESCRIPTORS_QTY] = {\n"
+    for reg in regs_map["regs"]:
+        out += "    {%s, %d, %d, 0x%04X, 0x%04X, RG_STORAGE_%s, RG_ACCESS_%s, RG_TYPE_%s},\n" % (
+            reg["name"], reg["qty"], reg["storage_address"], reg["min"], reg["max"],
+            STORAGES[reg["storage"]], ACCESSES[reg["access"]], TYPES[reg["type"]])
+    out += "};\n"
+    return out
+
+
+def gen_py(schema:dict, regs_map:dict) -> str:
+    out = "# Registers map, generated by regs_gen.py from registers.yaml, don't edit\n\n\n"
+    out += "RG_MEMORY_MAP_VERSION = 0x%04X\n" % schema["memory_map_version"]
+    out += "RG_MAX_REG_ADDR = %d\n\n" % regs_map["max_address"]
+    for reg in regs_map["regs"]:
+        out += "%s = %d\n" % (reg["name"], reg["address"])
+        if reg["type"] == "bytes":
+            out += "%s_SIZE = %d\n" % (reg["name"], reg["size"])
+    out += "\n"
+    for cmd in schema["commands"]:
+        out += "RG_CMD_%s = %d\n" % (cmd["name"], cmd["value"])
+    out += "\n"
+    for item in schema["profile_format"]:
+        out += "RG_PROFILE_%s = %d\n" % (item["name"], item["value"])
+    out += "RG_PROFILES_QTY = %d\n\n" % schema["profiles_qty"]
+
+    out += "# name: (address, qty, storage, access, type, min, max)\n"
+    out += "REGISTERS = {\n"
+    for reg in regs_map["regs"]:
+        out += "    \"%s\": (%d, %d, \"%s\", \"%s\", \"%s\", %d, %d),\n" % (
+            reg["name"], reg["address"], reg["qty"], reg["storage"], reg["access"], reg["type"], reg["min"], reg["max"])
+    out += "}\n\n\n"
+    out += "def check_write(address:int, values:list) -> bool:\n"
+    out += "    # Same check as device does, the whole write is rejected on any error\n"
+    out += "    for i, value in enumerate(values):\n"
+    out += "        reg = next((reg for reg in REGISTERS.values() if reg[0] <= (address + i) < (reg[0] + reg[1])), None)\n"
+    out += "        if (reg is None) or (reg[3] != \"rw\") or not (reg[5] <= value <= reg[6]):\n"
+    out += "            return False\n"
+    out += "    return True\n"
+    return out
+
+
+
+
+if __name__ == "__main__":
+    # Usage: regs_gen.py [--check] - check mode fails if generated files are outdated
+    with open(schema_file_name, "r") as f:
+        schema = yaml.safe_load(f)
+    regs_map = build_map(schema)
+    outputs = {
+        c_header_file_name: gen_c_header(schema, regs_map),
+        c_source_file_name: gen_c_source(regs_map),
+        py_file_name: gen_py(schema, regs_map)
+    }
+
+    is_outdated = False
+    for file_name, text in outputs.items():
+        try:
+            with open(file_name, "r", newline="\n") as f:
+                if f.read() == text:
+                    continue
+        except FileNotFoundError:
+            pass
+        is_outdated = True
+        if "--check" in sys.argv:
+            print(file_name + " is outdated")
+            continue
+        with open(file_name, "w", newline="\n") as f:
+            f.write(text)
+        print(file_name + " is generated")
+    sys.exit(1 if (is_outdated and ("--check" in sys.argv)) else 0)
@@ -0,0 +1,104 @@
+# Registers map, generated by regs_gen.py from registers.yaml, don't edit
+
+
+RG_MEMORY_MAP_VERSION = 0x0007
+RG_MAX_REG_ADDR = 2310
+
+RG_RAM_RO_REG_MEMORY_MAP_VERSION = 0
+RG_RAM_RO_REG_DEVIE_ID_0 = 1
+RG_RAM_RO_REG_DEVIE_ID_1 = 2
+RG_RAM_RO_REG_DEVIE_VER_MINOR = 3
+RG_RAM_RO_REG_DEVIE_VER_MAJOR = 4
+RG_RAM_RO_REG_FAIL_CODE = 5
+RG_RAM_RO_REG_WARN_CODE = 6
+RG_RAM_RW_REG_CMD = 7
+RG_FLASH_RW_REG_PROFILES_AREA = 8
+RG_FLASH_RW_REG_PROFILES_AREA_SIZE = 540
+RG_EE_REG_HEATER_ACTIVE_TIME_MS_LO = 1024
+RG_EE_REG_HEATER_ACTIVE_TIME_MS_HI = 1025
+RG_EE_REG_HEATER_DELAY_TIME_MS_LO = 1026
+RG_EE_REG_HEATER_DELAY_TIME_MS_HI = 1027
+RG_EE_REG_HEATER_HIST_ON_C = 1028
+RG_EE_REG_HEATER_HIST_OFF_C = 1029
+RG_JOURNAL_RW_REG_EVENT_INDEX = 2048
+RG_JOURNAL_RO_REG_EVENTS_QTY = 2049
+RG_JOURNAL_RO_REG_EVENT_TIME_MS_LO = 2050
+RG_JOURNAL_RO_REG_EVENT_TIME_MS_HI = 2051
+RG_JOURNAL_RO_REG_EVENT_SOURCE = 2052
+RG_JOURNAL_RO_REG_EVENT_FLAG = 2053
+RG_JOURNAL_RO_REG_EVENT_CODE_LO = 2054
+RG_JOURNAL_RO_REG_EVENT_CODE_HI = 2055
+RG_JOURNAL_RO_REG_EVENT_CONTEXT_LO = 2056
+RG_JOURNAL_RO_REG_EVENT_CONTEXT_HI = 2057
+RG_VDDA_REG_MV = 2304
+RG_VDDA_REG_MIN_MV = 2305
+RG_VDDA_REG_AVG_MV = 2306
+RG_VDDA_REG_MAX_MV = 2307
+RG_VDDA_REG_HEATER_ON_MIN_MV = 2308
+RG_VDDA_REG_SAGS_QTY = 2309
+RG_VDDA_REG_HEATER_SAGS_QTY = 2310
+
+RG_CMD_NOP = 0
+RG_CMD_REBOOT = 1
+RG_CMD_CLEAR_FLASH = 2
+RG_CMD_FLASH_COMMIT = 3
+
+RG_PROFILE_HDR_NAME_SIZE_OFFSET = 0
+RG_PROFILE_HDR_STAGES_QTY_OFFSET = 1
+RG_PROFILE_HDR_SIZE = 2
+RG_PROFILE_NAME_SIZE = 18
+RG_PROFILE_STAGE_FLAGS_OFFSET = 0
+RG_PROFILE_STAGE_TEMPERATURE_C_OFFSET = 1
+RG_PROFILE_STAGE_DURATION_S_OFFSET = 2
+RG_PROFILE_STAGE_SIZE = 4
+RG_PROFILE_STAGE_FUN_PERIOD_S_OFFSET = 0
+RG_PROFILE_STAGE_FUN_DUTY_CYCLE_PCT_OFFSET = 2
+RG_PROFILE_STAGE_FUN_SIZE = 3
+RG_PROFILE_STAGE_FLAG_FUN = 1
+RG_PROFILE_STAGES_QTY = 8
+RG_PROFILES_QTY = 10
+
+# name: (address, qty, storage, access, type, min, max)
+REGISTERS = {
+    "RG_RAM_RO_REG_MEMORY_MAP_VERSION": (0, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_RAM_RO_REG_DEVIE_ID_0": (1, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_RAM_RO_REG_DEVIE_ID_1": (2, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_RAM_RO_REG_DEVIE_VER_MINOR": (3, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_RAM_RO_REG_DEVIE_VER_MAJOR": (4, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_RAM_RO_REG_FAIL_CODE": (5, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_RAM_RO_REG_WARN_CODE": (6, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_RAM_RW_REG_CMD": (7, 1, "ram", "rw", "u16", 0, 3),
+    "RG_FLASH_RW_REG_PROFILES_AREA": (8, 270, "flash", "rw", "bytes", 0, 65535),
+    "RG_EE_REG_HEATER_ACTIVE_TIME_MS_LO": (1024, 1, "ee", "rw", "u16", 0, 65535),
+    "RG_EE_REG_HEATER_ACTIVE_TIME_MS_HI": (1025, 1, "ee", "rw", "u16", 0, 65535),
+    "RG_EE_REG_HEATER_DELAY_TIME_MS_LO": (1026, 1, "ee", "rw", "u16", 0, 65535),
+    "RG_EE_REG_HEATER_DELAY_TIME_MS_HI": (1027, 1, "ee", "rw", "u16", 0, 65535),
+    "RG_EE_REG_HEATER_HIST_ON_C": (1028, 1, "ee", "rw", "u16", 0, 255),
+    "RG_EE_REG_HEATER_HIST_OFF_C": (1029, 1, "ee", "rw", "u16", 0, 255),
+    "RG_JOURNAL_RW_REG_EVENT_INDEX": (2048, 1, "ram", "rw", "u16", 0, 7),
+    "RG_JOURNAL_RO_REG_EVENTS_QTY": (2049, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_JOURNAL_RO_REG_EVENT_TIME_MS_LO": (2050, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_JOURNAL_RO_REG_EVENT_TIME_MS_HI": (2051, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_JOURNAL_RO_REG_EVENT_SOURCE": (2052, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_JOURNAL_RO_REG_EVENT_FLAG": (2053, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_JOURNAL_RO_REG_EVENT_CODE_LO": (2054, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_JOURNAL_RO_REG_EVENT_CODE_HI": (2055, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_JOURNAL_RO_REG_EVENT_CONTEXT_LO": (2056, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_JOURNAL_RO_REG_EVENT_CONTEXT_HI": (2057, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_VDDA_REG_MV": (2304, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_VDDA_REG_MIN_MV": (2305, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_VDDA_REG_AVG_MV": (2306, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_VDDA_REG_MAX_MV": (2307, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_VDDA_REG_HEATER_ON_MIN_MV": (2308, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_VDDA_REG_SAGS_QTY": (2309, 1, "ram", "ro", "u16", 0, 65535),
+    "RG_VDDA_REG_HEATER_SAGS_QTY": (2310, 1, "ram", "ro", "u16", 0, 65535),
+}
+
+
+def check_write(address:int, values:list) -> bool:
+    # Same check as device does, the whole write is rejected on any error
+    for i, value in enumerate(values):
+        reg = next((reg for reg in REGISTERS.values() if reg[0] <= (address + i) < (reg[0] + reg[1])), None)
+        if (reg is None) or (reg[3] != "rw") or not (reg[5] <= value <= reg[6]):
+            return False
+    return True
@@ -4,11 +4,36 @@
 #include "button_driver.h"
 
 
+typedef struct {
+    uint8_t button_index;
+    bool is_down;
+    uint32_t time_ms;
+} button_edge_t;
+
+
 static button_t *buttons[BUTTON_MAX_QTY];
 static uint8_t buttons_qty = 0;
+static uint32_t exti_lines_mask = 0;
+
+// EXTI -> button_process()
+static button_edge_t edges[BUTTON_EDGES_QUEUE_SIZE];
+static volatile uint8_t edges_head = 0, edges_tail = 0;
+
+// button_process() -> application
+static button_event_t events[BUTTON_EVENTS_QUEUE_SIZE];
+static uint8_t events_head = 0, events_tail = 0;
+static uint32_t lost_events_qty = 0;
+
+
+static uint32_t get_pin_port_index(gpio_pin_t pin);
+static void exti_config(gpio_pin_t pin);
+static bool capture_edge(uint8_t button_index, bool is_down, uint32_t time_ms);
+static void settle_check(uint8_t button_index);
+static void single_button_edge_process(button_t *button, bool is_down, uint32_t time_ms);
+static void single_button_hold_process(button_t *button);
+static void push_event(button_t *button, button_event_type_t type, uint32_t time_ms);
 
 
-static void single_button_process(button_t *button);
 
 
 void button_init(button_t *button) {
@@ -17,21 +42,74 @@ void button_init(button_t *button) {
     #endif   // LIB_DEBUG_EH
 
     buttons[buttons_qty] = button;
-    gpio_config_pins(buttons[buttons_qty]->button_pin, GPIO_MODE_INPUT, GPIO_PULL_NONE, GPIO_SPEED_LOW, 0, false);
-    buttons[buttons_qty]->button_process_state = BT_PROCESS_STATE_UP;
-    buttons[buttons_qty]->is_button_press_event = false;
-    buttons[buttons_qty]->is_button_long_press_event = false;
+    gpio_config_pins(button->button_pin, GPIO_MODE_INPUT, GPIO_PULL_NONE, GPIO_SPEED_LOW, 0, false);
+    // Button held at start up gives no events until the next press
+    button->is_down = false;
+    button->is_down_captured = button_is_pressed(button);
+    button->is_settling = false;
+    button->edge_time_ms = get_time_ms() - BUTTON_DEBOUNCE_TIME_MS;
+    button->is_long_press = false;
+    button->is_click_pending = false;
+    button->is_latched = false;
 
     buttons_qty++;
+    exti_config(button->button_pin);
 }
 
 
+//  ***************************************************************************
+/// @brief  Convert captured edges to events
+/// @param  none
+/// @return none
+/// @note   Costs only queue check if buttons are released and stable
+//  ***************************************************************************
 void button_process(void) {
+    button_edge_t *edge;
     uint32_t i;
 
 
     for (i = 0; i < buttons_qty; i++) {
-        single_button_process(buttons[i]);
+        if (buttons[i]->is_settling) settle_check(i);
+    }
+
+    while (edges_tail != edges_head) {
+        edge = &edges[edges_tail];
+        single_button_edge_process(buttons[edge->button_index], edge->is_down, edge->time_ms);
+        edges_tail = (edges_tail + 1) & (BUTTON_EDGES_QUEUE_SIZE - 1);
+    }
+
+    for (i = 0; i < buttons_qty; i++) {
+        if (buttons[i]->is_down) single_button_hold_process(buttons[i]);
+    }
+}
+
+
+//  ***************************************************************************
+/// @brief  EXTI interrupt: capture button edges
+/// @param  none
+/// @return none
+/// @note   The first edge is accepted at once, bounces after it are ignored
+///         for debounce time and checked by button_process() later
+//  ***************************************************************************
+void button_exti_handler(void) {
+    uint32_t pending, time_ms, i;
+    button_t *button;
+    bool is_down;
+
+
+    pending = EXTI->PR & exti_lines_mask;
+    EXTI->PR = pending;   // Clear flags
+    time_ms = get_time_ms();
+
+    for (i = 0; i < buttons_qty; i++) {
+        button = buttons[i];
+        if ((pending & (1ul << gpio_get_pin_n(button->button_pin))) == 0) continue;
+
+        button->is_settling = true;
+        is_down = button_is_pressed(button);
+        if (is_down == button->is_down_captured) continue;
+        if ((time_ms - button->edge_time_ms) < BUTTON_DEBOUNCE_TIME_MS) continue;
+        capture_edge(i, is_down, time_ms);
     }
 }
 
@@ -42,79 +120,196 @@ bool button_is_pressed(button_t *button) {
 }
 
 
-bool button_is_press_event(button_t *button) {
-    bool is_event = button->is_button_press_event;
-    button->is_button_press_event = false;
-    return is_event;
+//  ***************************************************************************
+/// @brief  Get the oldest event
+/// @param  event - [out] event
+/// @return true - event is removed from queue, false - no events
+//  ***************************************************************************
+bool button_get_event(button_event_t *event) {
+    if (events_tail == events_head) return false;
+
+    *event = events[events_tail];
+    events_tail = (events_tail + 1) & (BUTTON_EVENTS_QUEUE_SIZE - 1);
+    return true;
+}
+
+
+//  ***************************************************************************
+/// @brief  Drop queued events, buttons state is kept
+/// @param  none
+/// @return none
+/// @note   The next click can't be the second click of DOUBLE_CLICK. Buttons
+///         held down give no events (LONG_PRESS, HOLD_REPEAT, CLICK) until
+///         released.
+//  ***************************************************************************
+void button_flush_events(void) {
+    uint32_t i;
+
+
+    button_process();
+    events_tail = events_head;
+    for (i = 0; i < buttons_qty; i++) {
+        buttons[i]->is_click_pending = false;
+        if (buttons[i]->is_down) buttons[i]->is_latched = true;
+    }
+}
+
+
+//  ***************************************************************************
+/// @brief  Get qty of events lost on full events queue
+/// @param  none
+/// @return qty
+//  ***************************************************************************
+uint32_t button_get_lost_events_qty(void) {
+    return lost_events_qty;
+}
+
+
+
+
+static uint32_t get_pin_port_index(gpio_pin_t pin) {
+    uint32_t port_index = 0;
+
+
+    // GPIOx_ID: bit (16 + port index)
+    while (((pin >> (16 + port_index)) & 1) == 0) port_index++;
+    return port_index;
+}
+
+
+static void exti_config(gpio_pin_t pin) {
+    uint32_t line = gpio_get_pin_n(pin);
+    uint32_t shift = (line % 4) * 4;
+
+
+    sysclk_enable_peripheral(SYSCFG);
+    SYSCFG->EXTICR[line / 4] = (SYSCFG->EXTICR[line / 4] & ~(0x0Ful << shift)) | (get_pin_port_index(pin) << shift);
+
+    EXTI->PR = 1ul << line;
+    EXTI->RTSR |= 1ul << line;
+    EXTI->FTSR |= 1ul << line;
+    EXTI->IMR |= 1ul << line;
+    exti_lines_mask |= 1ul << line;
+}
+
+
+//  ***************************************************************************
+/// @brief  Put edge to queue, called from EXTI or with interrupts disabled
+/// @param  button_index - buttons[] index
+/// @param  is_down - new button state
+/// @param  time_ms - edge time
+/// @return true - success, false - queue is full (edge is taken again by
+///         settle check)
+//  ***************************************************************************
+static bool capture_edge(uint8_t button_index, bool is_down, uint32_t time_ms) {
+    uint8_t head_next = (edges_head + 1) & (BUTTON_EDGES_QUEUE_SIZE - 1);
+
+
+    if (head_next == edges_tail) return false;
+
+    edges[edges_head].button_index = button_index;
+    edges[edges_head].is_down = is_down;
+    edges[edges_head].time_ms = time_ms;
+    edges_head = head_next;
+
+    buttons[button_index]->is_down_captured = is_down;
+    buttons[button_index]->edge_time_ms = time_ms;
+    return true;
+}
+
+
+//  ***************************************************************************
+/// @brief  Take the last edge ignored by debounce
+/// @param  button_index - buttons[] index
+/// @return none
+//  ***************************************************************************
+static void settle_check(uint8_t button_index) {
+    button_t *button = buttons[button_index];
+    uint32_t time_ms;
+    bool is_down;
+
+
+    __disable_irq();
+    time_ms = get_time_ms();
+    if ((time_ms - button->edge_time_ms) >= BUTTON_DEBOUNCE_TIME_MS) {
+        is_down = button_is_pressed(button);
+        if ((is_down == button->is_down_captured) || capture_edge(button_index, is_down, time_ms)) {
+            button->is_settling = false;
+        }
+    }
+    __enable_irq();
 }
 
 
-bool button_is_long_press_event(button_t *button) {
-    bool is_event = button->is_button_long_press_event;
-    button->is_button_long_press_event = false;
-    return is_event;
+static void single_button_edge_process(button_t *button, bool is_down, uint32_t time_ms) {
+    if (is_down == button->is_down) return;
+    button->is_down = is_down;
+
+    // Release of button latched by flush
+    if (button->is_latched) {
+        button->is_latched = false;
+        return;
+    }
+
+    if (is_down) {
+        button->press_time_ms = time_ms;
+        button->hold_time_ms = time_ms + BUTTON_LONG_PRESS_TIME_MS;
+        button->is_long_press = false;
+        return;
+    }
+
+    if (button->is_long_press) return;
+    // Held for long press time while events weren't processed
+    if ((time_ms - button->press_time_ms) >= BUTTON_LONG_PRESS_TIME_MS) {
+        push_event(button, BUTTON_EVENT_LONG_PRESS, button->hold_time_ms);
+        return;
+    }
+
+    push_event(button, BUTTON_EVENT_CLICK, time_ms);
+    if (button->is_click_pending && ((time_ms - button->click_time_ms) <= BUTTON_DOUBLE_CLICK_TIME_MS)) {
+        push_event(button, BUTTON_EVENT_DOUBLE_CLICK, time_ms);
+        button->is_click_pending = false;
+    }
+    else {
+        button->is_click_pending = true;
+        button->click_time_ms = time_ms;
+    }
 }
 
 
-void button_clear_events_flags(button_t *button) {
-    button->is_button_press_event = false;
-    button->is_button_long_press_event = false;
+static void single_button_hold_process(button_t *button) {
+    uint32_t time_ms = get_time_ms();
+
+
+    if (button->is_latched) return;
+    if ((int32_t)(time_ms - button->hold_time_ms) < 0) return;
+
+    if (!button->is_long_press) {
+        push_event(button, BUTTON_EVENT_LONG_PRESS, button->hold_time_ms);
+        button->is_long_press = true;
+        button->is_click_pending = false;
+    }
+    else {
+        push_event(button, BUTTON_EVENT_HOLD_REPEAT, button->hold_time_ms);
+    }
+
+    // Repeats missed by busy main loop are skipped
+    button->hold_time_ms += BUTTON_HOLD_REPEAT_PERIOD_MS;
+    if ((int32_t)(time_ms - button->hold_time_ms) >= 0) button->hold_time_ms = time_ms + BUTTON_HOLD_REPEAT_PERIOD_MS;
 }
 
 
+static void push_event(button_t *button, button_event_type_t type, uint32_t time_ms) {
+    uint8_t head_next = (events_head + 1) & (BUTTON_EVENTS_QUEUE_SIZE - 1);
 
 
-static void single_button_process(button_t *button) {
-    bool is_button_down = button_is_pressed(button);
-    switch (button->button_process_state) {
-        case BT_PROCESS_STATE_UP:
-            if (is_button_down) {
-                button->button_process_state = BT_PROCESS_STATE_UP_DEBOUNCE;
-                button->debounce_timer = timer_start_ms(BUTTON_DEBOUNCE_TIME_MS);
-            }
-            break;
-
-        case BT_PROCESS_STATE_UP_DEBOUNCE:
-            if (timer_triggered(button->debounce_timer)) {
-                if (is_button_down) {
-                    button->button_process_state = BT_PROCESS_STATE_DOWN;
-                    button->long_press_timer = timer_start_ms(BUTTON_LONG_PRESS_TIME_MS);
-                }
-                else {
-                    button->button_process_state = BT_PROCESS_STATE_UP;
-                }
-            }
-            break;
-
-        case BT_PROCESS_STATE_DOWN:
-            if (!is_button_down) {
-                button->button_process_state = BT_PROCESS_STATE_DOWN_DEBOUNCE;
-                button->debounce_timer = timer_start_ms(BUTTON_DEBOUNCE_TIME_MS);
-            }
-            else if (timer_triggered(button->long_press_timer)) {
-                button->button_process_state = BT_PROCESS_STATE_LONG_DOWN;
-                button->is_button_long_press_event = true;
-            }
-            break;
-
-        case BT_PROCESS_STATE_LONG_DOWN:
-            if (!is_button_down) {
-                button->button_process_state = BT_PROCESS_STATE_DOWN_DEBOUNCE;
-                button->debounce_timer = timer_start_ms(BUTTON_DEBOUNCE_TIME_MS);
-            }
-            break;
-
-        case BT_PROCESS_STATE_DOWN_DEBOUNCE:
-            if (timer_triggered(button->debounce_timer)) {
-                if (!is_button_down) {
-                    if (!timer_triggered(button->long_press_timer)) button->is_button_press_event = true;
-                    button->button_process_state = BT_PROCESS_STATE_UP;
-                }
-                else {
-                    if (!timer_triggered(button->long_press_timer)) button->button_process_state = BT_PROCESS_STATE_DOWN;
-                    else button->button_process_state = BT_PROCESS_STATE_LONG_DOWN;
-                }
-            }
-            break; 
+    if (head_next == events_tail) {
+        lost_events_qty++;
+        return;
     }
+
+    events[events_head].button = button;
+    events[events_head].type = type;
+    events[events_head].time_ms = time_ms;
+    events_head = head_next;
 }
@@ -1,6 +1,9 @@
 //  ***************************************************************************
 /// @file    button_driver.h
 /// @brief   Button driver
+/// @note    Edges are captured by EXTI with timestamps, button_process()
+///          turns them into events queue. Events are classified by edges
+///          timestamps, so busy main loop doesn't change or lose them.
 //  ***************************************************************************
 #ifndef _BUTTON_DRIVER_H_
 #define _BUTTON_DRIVER_H_
@@ -8,6 +11,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include "common/mcu.h"
 #include "common/error.h"
 #include "hal/gpio.h"
 #include "hal/sysclk.h"
@@ -16,38 +20,54 @@
 
 #define BUTTON_MAX_QTY (2)
 
-#define BUTTON_DEBOUNCE_TIME_MS   (100)
-#define BUTTON_LONG_PRESS_TIME_MS (1000)
+#define BUTTON_DEBOUNCE_TIME_MS       (50)
+#define BUTTON_LONG_PRESS_TIME_MS     (1000)
+#define BUTTON_HOLD_REPEAT_PERIOD_MS  (250)
+#define BUTTON_DOUBLE_CLICK_TIME_MS   (400)     // between releases
+
+#define BUTTON_EDGES_QUEUE_SIZE       (16)      // power of 2
+#define BUTTON_EVENTS_QUEUE_SIZE      (8)       // power of 2
 
 
 typedef enum {
-    BT_PROCESS_STATE_UP,
-    BT_PROCESS_STATE_UP_DEBOUNCE,
-    BT_PROCESS_STATE_DOWN,
-    BT_PROCESS_STATE_LONG_DOWN,
-    BT_PROCESS_STATE_DOWN_DEBOUNCE,
-} button_process_state_t;
+    BUTTON_EVENT_CLICK = 0,         // released before long press time
+    BUTTON_EVENT_DOUBLE_CLICK,      // after CLICK of the second click
+    BUTTON_EVENT_LONG_PRESS,        // held for long press time
+    BUTTON_EVENT_HOLD_REPEAT        // after LONG_PRESS, every hold repeat period
+} button_event_type_t;
 
 typedef struct {
     // Public variables
-    gpio_pin_t button_pin;
+    gpio_pin_t button_pin;          // GPIO line number must be unique
     bool is_inverse_button;
     // Private variables
-    button_process_state_t button_process_state;
-    timer_t debounce_timer;
-    timer_t long_press_timer;
-    bool is_button_press_event;
-    bool is_button_long_press_event;
+    volatile bool is_down_captured; // last accepted edge, EXTI
+    volatile bool is_settling;
+    volatile uint32_t edge_time_ms;
+    bool is_down;                   // last processed edge
+    bool is_long_press;
+    bool is_click_pending;
+    bool is_latched;                // down at flush, no events until release
+    uint32_t press_time_ms;
+    uint32_t click_time_ms;
+    uint32_t hold_time_ms;          // next LONG_PRESS / HOLD_REPEAT
 } button_t;
 
+typedef struct {
+    button_t *button;
+    button_event_type_t type;
+    uint32_t time_ms;
+} button_event_t;
+
 
 extern void button_init(button_t *button);
 extern void button_process(void);
+extern void button_exti_handler(void);
 
 extern bool button_is_pressed(button_t *button);
-extern bool button_is_press_event(button_t *button);
-extern bool button_is_long_press_event(button_t *button);
-extern void button_clear_events_flags(button_t *button);
+extern bool button_get_event(button_event_t *event);
+extern void button_flush_events(void);
+extern uint32_t button_get_lost_events_qty(void);
 
 
 #endif   // _BUTTON_DRIVER_H_
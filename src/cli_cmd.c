@@ -10,9 +10,20 @@
 #include "common/parsers.h"
 #include "common/error.h"
 #include "hal/systimer.h"
+#include "hal/timebase.h"
 #include "system_operation.h"
 #include "outputs_driver.h"
 #include "registers.h"
+#include "flash.h"
+#include "telemetry.h"
+#include "watchdog.h"
+#include "event_journal.h"
+#include "crash_dump.h"
+#include "vdda_monitor.h"
+
+
+#define CLI_FIMG_CHUNK_SIZE         (64)
+#define CLI_FIMG_RX_TIMEOUT_MS      (1000)
 
 
 static error_t cli_cmd_reboot(uint32_t argc, const uint8_t **argv, cli_call_state_t state);
@@ -22,13 +33,58 @@ static error_t cli_cmd_clidbg(uint32_t argc, const uint8_t **argv, cli_call_stat
 static error_t cli_cmd_tlog(uint32_t argc, const uint8_t **argv, cli_call_state_t state);
 static error_t cli_cmd_tset(uint32_t argc, const uint8_t **argv, cli_call_state_t state);
 static error_t cli_cmd_tconf(uint32_t argc, const uint8_t **argv, cli_call_state_t state);
+static error_t cli_cmd_fimg(uint32_t argc, const uint8_t **argv, cli_call_state_t state);
 static error_t cli_cmd_fset(uint32_t argc, const uint8_t **argv, cli_call_state_t state);
+static error_t cli_cmd_clistat(uint32_t argc, const uint8_t **argv, cli_call_state_t state);
+static error_t cli_cmd_trace(uint32_t argc, const uint8_t **argv, cli_call_state_t state);
+static error_t cli_cmd_runlog(uint32_t argc, const uint8_t **argv, cli_call_state_t state);
+static error_t cli_cmd_elog(uint32_t argc, const uint8_t **argv, cli_call_state_t state);
+static error_t cli_cmd_crash(uint32_t argc, const uint8_t **argv, cli_call_state_t state);
+static error_t cli_cmd_vdda(uint32_t argc, const uint8_t **argv, cli_call_state_t state);
 
 static bool pars_string_to_s32_and_check(const uint8_t *str, int32_t *digit, int32_t min, int32_t max);
 static bool pars_string_to_u32_and_check(const uint8_t *str, uint32_t *digit, uint32_t min, uint32_t max);
 
 
+static timebase_capture_t main_loop_capture;   // cli_cmd_process() is called once per main loop
+
+// Sorted by name (strcmp order) for binary search
 const cli_cmd_t cli_cmds[] = {
+    {
+        .name = "clidbg",
+        .usage = "en",
+        .func = cli_cmd_clidbg
+    },
+    {
+        .name = "clistat",
+        .usage = "",
+        .func = cli_cmd_clistat
+    },
+    {
+        .name = "crash",
+        .usage = "",
+        .func = cli_cmd_crash
+    },
+    {
+        .name = "elog",
+        .usage = "",
+        .func = cli_cmd_elog
+    },
+    {
+        .name = "fimg",
+        .usage = "rd|wr",
+        .func = cli_cmd_fimg
+    },
+    {
+        .name = "fset",
+        .usage = "PERIOD_S DUTY_CYCLE_PCT",
+        .func = cli_cmd_fset
+    },
+    {
+        .name = "help",
+        .usage = "",
+        .func = cli_cmd_help
+    },
     {
         .name = "reboot",
         .usage = "",
@@ -40,34 +96,39 @@ const cli_cmd_t cli_cmds[] = {
         .func = cli_cmd_rr
     },
     {
-        .name = "wr",
-        .usage = "ADDR VAL",
-        .func = cli_cmd_wr
+        .name = "runlog",
+        .usage = "",
+        .func = cli_cmd_runlog
     },
     {
-        .name = "clidbg",
-        .usage = "en",
-        .func = cli_cmd_clidbg
+        .name = "tconf",
+        .usage = "[ACT_MS DELAY_MS HYST_ON_C HYST_OFF_C]",
+        .func = cli_cmd_tconf
     },
     {
         .name = "tlog",
-        .usage = "PERIOD_MS",
+        .usage = "PERIOD_MS [bin]",
         .func = cli_cmd_tlog
     },
+    {
+        .name = "trace",
+        .usage = "",
+        .func = cli_cmd_trace
+    },
     {
         .name = "tset",
         .usage = "TEMPERATURE_C",
         .func = cli_cmd_tset
     },
     {
-        .name = "tconf",
-        .usage = "[ACT_MS DELAY_MS HYST_ON_C HYST_OFF_C]",
-        .func = cli_cmd_tconf
+        .name = "vdda",
+        .usage = "[clr]",
+        .func = cli_cmd_vdda
     },
     {
-        .name = "fset",
-        .usage = "PERIOD_S DUTY_CYCLE_PCT",
-        .func = cli_cmd_fset
+        .name = "wr",
+        .usage = "ADDR VAL",
+        .func = cli_cmd_wr
     },
 };
 
@@ -77,17 +138,21 @@ const cli_cmd_t cli_cmds[] = {
 void cli_cmd_init(void) {
     usb_cdc_init();
     cli_init(usb_cdc_send_data, usb_cdc_receive_data, cli_cmds, (sizeof(cli_cmds) / sizeof(cli_cmd_t)));
+    timebase_capture_reset(&main_loop_capture);
 }
 
 
 void cli_cmd_process(void) {
+    timebase_capture(&main_loop_capture);
     cli_process();
+    watchdog_check_in(WATCHDOG_TASK_CLI);
 }
 
 
 
 
 static error_t cli_cmd_reboot(uint32_t argc, const uint8_t **argv, cli_call_state_t state)  {
+    if (flash_is_dirty()) flash_commit();
     NVIC_SystemReset();
     return E_OK;
 }
@@ -101,13 +166,8 @@ static error_t cli_cmd_rr(uint32_t argc, const uint8_t **argv, cli_call_state_t
     if (argc != 2) return E_INVALID_ARG;
     if (!pars_string_to_u32_and_check(argv[1], &addr, 0, RG_MAX_REG_ADDR)) return E_INVALID_ARG;
 
-    if (regs_read_reg(addr, &reg_value)) {
-        cli_safe_printf("%d", reg_value);
-    }
-    else {
-        return E_FAILED;
-    }
-    return E_OK;
+    if (!regs_read_reg(addr, &reg_value)) return E_FAILED;
+    return cli_printf_async("%d", reg_value);
 }
 
 
@@ -139,20 +199,40 @@ static error_t cli_cmd_clidbg(uint32_t argc, const uint8_t **argv, cli_call_stat
 static error_t cli_cmd_tlog(uint32_t argc, const uint8_t **argv, cli_call_state_t state) {
     static uint32_t log_period_ms;
     static timer_t log_timer;
+    static bool is_bin_mode;
+    uint8_t record[TELEMETRY_RECORD_SIZE];
 
 
     if (state == CLI_CALL_FIRST) {
-        if (argc != 2) return E_INVALID_ARG;
-        if (!pars_string_to_u32_and_check(argv[1], &log_period_ms, 0, 0)) return E_INVALID_ARG;
+        if ((argc != 2) && (argc != 3)) return E_INVALID_ARG;
+        is_bin_mode = false;
+        if (argc == 3) {
+            if (!pars_is_there_template_in_string(argv[2], "bin")) return E_INVALID_ARG;
+            is_bin_mode = true;
+        }
+
+        if (is_bin_mode) {
+            if (!pars_string_to_u32_and_check(argv[1], &log_period_ms, TELEMETRY_MIN_PERIOD_MS, TELEMETRY_MAX_PERIOD_MS)) return E_INVALID_ARG;
+            telemetry_start(log_period_ms);
+            return E_ASYNC_WAIT;
+        }
 
-        cli_safe_printf("Temp_c; Heat_en");
+        if (!pars_string_to_u32_and_check(argv[1], &log_period_ms, 0, 0)) return E_INVALID_ARG;
+        cli_printf("Temp_c; Heat_en");
         log_timer = timer_start_ms(log_period_ms);
         return E_ASYNC_WAIT;
     }
     if (state == CLI_CALL_REPEATED) {
+        if (is_bin_mode) {
+            if (telemetry_is_record_ready(record)) {
+                cli_write(record, sizeof(record));   // record is dropped if host is slow, seq shows the gap
+            }
+            return E_ASYNC_WAIT;
+        }
+
         if (timer_triggered(log_timer)) {
             log_timer = timer_restart_ms(log_timer, log_period_ms);
-            cli_safe_printf("\r\n%d; %d", heater_current_temperature_c, is_heater_pin_en);
+            cli_printf("\r\n%d; %d", heater_current_temperature_c, is_heater_pin_en);   // record is dropped if host is slow
             return E_ASYNC_WAIT;
         }
 
@@ -168,7 +248,7 @@ static error_t cli_cmd_tset(uint32_t argc, const uint8_t **argv, cli_call_state_
 
     if (argc != 2) return E_INVALID_ARG;
     if (!is_cli_dbg_mode) {
-        cli_safe_printf("CLI debug mode disabled!");
+        cli_printf("CLI debug mode disabled!");
     }
     if (!pars_string_to_u32_and_check(argv[1], &temperature_c, 0, HEATER_MAX_TEMP_C)) return E_INVALID_ARG;
 
@@ -185,8 +265,7 @@ static error_t cli_cmd_tconf(uint32_t argc, const uint8_t **argv, cli_call_state
 
 
     if (argc == 1) {
-        cli_safe_printf("act_ms = %d\r\ndel_ms = %d\r\nhon_c = %d\r\nnoff_c = %d", heater_active_time_ms, heater_delay_time_ms, heater_hist_on_c, heater_hist_off_c);
-        return E_OK;
+        return cli_printf_async("act_ms = %d\r\ndel_ms = %d\r\nhon_c = %d\r\nnoff_c = %d", heater_active_time_ms, heater_delay_time_ms, heater_hist_on_c, heater_hist_off_c);
     }
     else if (argc == 5) {
         if (!pars_string_to_u32_and_check(argv[1], &active_time_ms, 0, 0)) return E_INVALID_ARG;
@@ -194,23 +273,101 @@ static error_t cli_cmd_tconf(uint32_t argc, const uint8_t **argv, cli_call_state
         if (!pars_string_to_u32_and_check(argv[3], &hist_on_c, 0, UINT8_MAX)) return E_INVALID_ARG;
         if (!pars_string_to_u32_and_check(argv[4], &hist_off_c, 0, UINT8_MAX)) return E_INVALID_ARG;
         
-        heater_active_time_ms = active_time_ms;
-        heater_delay_time_ms = delay_time_ms;
-        heater_hist_on_c = hist_on_c;
-        heater_hist_off_c = hist_off_c;
+        // Through registers: parameters are stored to EEPROM emulation
+        if (!regs_write_reg(RG_EE_REG_HEATER_ACTIVE_TIME_MS_LO, (uint16_t)active_time_ms)) return E_FAILED;
+        if (!regs_write_reg(RG_EE_REG_HEATER_ACTIVE_TIME_MS_HI, (uint16_t)(active_time_ms >> 16))) return E_FAILED;
+        if (!regs_write_reg(RG_EE_REG_HEATER_DELAY_TIME_MS_LO, (uint16_t)delay_time_ms)) return E_FAILED;
+        if (!regs_write_reg(RG_EE_REG_HEATER_DELAY_TIME_MS_HI, (uint16_t)(delay_time_ms >> 16))) return E_FAILED;
+        if (!regs_write_reg(RG_EE_REG_HEATER_HIST_ON_C, hist_on_c)) return E_FAILED;
+        if (!regs_write_reg(RG_EE_REG_HEATER_HIST_OFF_C, hist_off_c)) return E_FAILED;
         return E_OK;
     }
     return E_INVALID_ARG;
 }
 
 
+//  ***************************************************************************
+/// @brief  Config FLASH page image transfer
+/// @note   "rd" - active copy page (FLASH_SIZE bytes) is sent as is.
+///         "wr" - page image is received in raw mode: data area goes to RAM
+///         shadow, CRC32 (crc_hw_32_posix) is checked over the whole page and
+///         image is committed. Sequence number from image is ignored, commit
+///         sets its own. Wrong CRC or pause longer than CLI_FIMG_RX_TIMEOUT_MS
+///         drops the image together with all not committed writes.
+//  ***************************************************************************
+static error_t cli_cmd_fimg(uint32_t argc, const uint8_t **argv, cli_call_state_t state) {
+    static bool is_write_mode;
+    static uint32_t offset, crc32_calc, crc32_real;
+    static timer_t rx_timer;
+    uint8_t buff[CLI_FIMG_CHUNK_SIZE];
+    uint32_t size, data_size, i;
+
+
+    if (state == CLI_CALL_FIRST) {
+        if (argc != 2) return E_INVALID_ARG;
+        if (pars_is_there_template_in_string(argv[1], "rd")) is_write_mode = false;
+        else if (pars_is_there_template_in_string(argv[1], "wr")) is_write_mode = true;
+        else return E_INVALID_ARG;
+
+        offset = 0;
+        if (is_write_mode) {
+            crc32_calc = crc_hw_32_posix.init ^ crc_hw_32_posix.xorout;   // CRC of no data
+            crc32_real = 0;
+            rx_timer = timer_start_ms(CLI_FIMG_RX_TIMEOUT_MS);
+            cli_set_rx_raw_mode(true);
+        }
+        return E_ASYNC_WAIT;
+    }
+    if (state == CLI_CALL_REPEATED) {
+        if (!is_write_mode) {
+            if (offset >= FLASH_SIZE) return E_OK;
+            if (cli_write_async((flash_get_data_ptr() + offset), CLI_FIMG_CHUNK_SIZE) == E_OK) offset += CLI_FIMG_CHUNK_SIZE;
+            return E_ASYNC_WAIT;
+        }
+
+        if (timer_triggered(rx_timer)) {
+            flash_discard();
+            return E_FAILED;
+        }
+        size = 0;
+        if (cli_read(buff, &size, ((FLASH_SIZE - offset) < sizeof(buff)) ? (FLASH_SIZE - offset) : sizeof(buff)) != E_OK) return E_ASYNC_WAIT;
+        if (size == 0) return E_ASYNC_WAIT;
+        rx_timer = timer_start_ms(CLI_FIMG_RX_TIMEOUT_MS);
+
+        if (offset < FLASH_SHADOW_SIZE) {
+            data_size = ((FLASH_SHADOW_SIZE - offset) < size) ? (FLASH_SHADOW_SIZE - offset) : size;
+            flash_write_bytes(offset, buff, data_size);
+        }
+        data_size = 0;
+        if (offset < FLASH_SIZE_FOR_CRC) {
+            data_size = ((FLASH_SIZE_FOR_CRC - offset) < size) ? (FLASH_SIZE_FOR_CRC - offset) : size;
+            crc32_calc = crc_hw_continue_clac(&crc_hw_32_posix, (crc32_calc ^ crc_hw_32_posix.xorout), buff, data_size);
+        }
+        for (i = data_size; i < size; i++) {
+            crc32_real |= (uint32_t)buff[i] << ((offset + i - FLASH_CRC32_ADDR) * 8);
+        }
+        offset += size;
+        if (offset < FLASH_SIZE) return E_ASYNC_WAIT;
+
+        if (crc32_calc != crc32_real) {
+            flash_discard();
+            return E_FAILED;
+        }
+        if (!flash_commit()) return E_FAILED;   // shadow is kept, commit is retried
+        return E_OK;
+    }
+    if (is_write_mode) flash_discard();
+    return E_OK;
+}
+
+
 static error_t cli_cmd_fset(uint32_t argc, const uint8_t **argv, cli_call_state_t state) {
     uint32_t period_s, duty_cycle_pct;
 
 
     if (argc != 3) return E_INVALID_ARG;
     if (!is_cli_dbg_mode) {
-        cli_safe_printf("CLI debug mode disabled!");
+        cli_printf("CLI debug mode disabled!");
     }
     if (!pars_string_to_u32_and_check(argv[1], &period_s, 0, 0)) return E_INVALID_ARG;
     if (!pars_string_to_u32_and_check(argv[2], &duty_cycle_pct, 0, 100)) return E_INVALID_ARG;
@@ -221,6 +378,180 @@ static error_t cli_cmd_fset(uint32_t argc, const uint8_t **argv, cli_call_state_
 
 
 
+static error_t cli_cmd_clistat(uint32_t argc, const uint8_t **argv, cli_call_state_t state) {
+    error_t result;
+
+
+    if (argc != 1) return E_INVALID_ARG;
+    result = cli_printf_async("tx_drop = %d, loop_us = %d..%d", cli_get_tx_dropped_bytes_qty(),
+                              main_loop_capture.min_period_us, main_loop_capture.max_period_us);
+    if (result == E_OK) timebase_capture_reset(&main_loop_capture);
+    return result;
+}
+
+
+
+static error_t cli_cmd_trace(uint32_t argc, const uint8_t **argv, cli_call_state_t state) {
+    static trace_iterator_t iterator;
+    static trace_sample_t sample;
+    static bool is_header_pending, is_sample_pending;
+
+
+    if (state == CLI_CALL_FIRST) {
+        if (argc != 1) return E_INVALID_ARG;
+        if (trace_is_recording()) {
+            cli_printf("Process is running!");
+            return E_FAILED;
+        }
+        trace_iterator_init(&iterator);
+        is_header_pending = true;
+        is_sample_pending = false;
+        return E_ASYNC_WAIT;
+    }
+    if (state == CLI_CALL_REPEATED) {
+        if (is_header_pending) {
+            if (cli_printf_async("Time_s; Temp_c; Set_c; Heat_pct") == E_OK) is_header_pending = false;
+            return E_ASYNC_WAIT;
+        }
+        if (!is_sample_pending) {
+            if (!trace_iterator_next(&iterator, &sample)) return E_OK;
+            is_sample_pending = true;
+        }
+        if (cli_printf_async("\r\n%d; %d.%d; %d; %d", sample.time_s, (sample.temperature_c_x10 / 10), (sample.temperature_c_x10 % 10), sample.setpoint_c, sample.heater_duty_pct) == E_OK) {
+            is_sample_pending = false;
+        }
+        return E_ASYNC_WAIT;
+    }
+    return E_OK;
+}
+
+
+
+static error_t cli_cmd_runlog(uint32_t argc, const uint8_t **argv, cli_call_state_t state) {
+    static const char * const results_names[] = {"DONE", "BREAK", "FAIL", "CLI_DBG"};
+    static uint32_t record_n;
+    static run_log_record_t record;
+    static bool is_header_pending, is_record_pending;
+    const char *result_name;
+
+
+    if (state == CLI_CALL_FIRST) {
+        if (argc != 1) return E_INVALID_ARG;
+        record_n = 0;
+        is_header_pending = true;
+        is_record_pending = false;
+        return E_ASYNC_WAIT;
+    }
+    if (state == CLI_CALL_REPEATED) {
+        if (is_header_pending) {
+            if (cli_printf_async("Seq; Prof; Result; Fail; Start_s; Dur_s; Peak_c; Over_c; Stage") == E_OK) is_header_pending = false;
+            return E_ASYNC_WAIT;
+        }
+        while (!is_record_pending) {
+            if (record_n >= run_log_get_records_qty()) return E_OK;
+            if (run_log_read(record_n, &record)) is_record_pending = true;
+            record_n++;
+        }
+        result_name = (record.result < (sizeof(results_names) / sizeof(results_names[0]))) ? results_names[record.result] : "?";
+        if (cli_printf_async("\r\n%d; %d; %s; 0x%04X; %d; %d; %d.%d; %d.%d; %d",
+                             record.seq, record.profile_index, result_name, record.fail_code, record.start_uptime_s, record.duration_s,
+                             (record.peak_temperature_c_x10 / 10), (record.peak_temperature_c_x10 % 10),
+                             (record.max_overshoot_c_x10 / 10), (record.max_overshoot_c_x10 % 10), record.last_stage_index) == E_OK) {
+            is_record_pending = false;
+        }
+        return E_ASYNC_WAIT;
+    }
+    return E_OK;
+}
+
+
+
+static error_t cli_cmd_elog(uint32_t argc, const uint8_t **argv, cli_call_state_t state) {
+    static const char * const sources_names[] = {"?", "FAIL", "WARN"};
+    static uint32_t entry_n;
+    static event_journal_entry_t entry;
+    static bool is_header_pending;
+
+
+    if (state == CLI_CALL_FIRST) {
+        if (argc != 1) return E_INVALID_ARG;
+        entry_n = 0;
+        is_header_pending = true;
+        return E_ASYNC_WAIT;
+    }
+    if (state == CLI_CALL_REPEATED) {
+        if (is_header_pending) {
+            if (cli_printf_async("Boot; Time_ms; Source; Flag; Code; Context") == E_OK) is_header_pending = false;
+            return E_ASYNC_WAIT;
+        }
+        if (!event_journal_read(entry_n, &entry)) return E_OK;
+        if (cli_printf_async("\r\n%s; %d; %s; 0x%04X; 0x%08X; %d",
+                             (entry.is_prev_boot ? "prev" : "this"), entry.time_ms,
+                             sources_names[(entry.source < (sizeof(sources_names) / sizeof(sources_names[0]))) ? entry.source : 0],
+                             entry.flag, entry.code, entry.context) == E_OK) {
+            entry_n++;
+        }
+        return E_ASYNC_WAIT;
+    }
+    return E_OK;
+}
+
+
+
+static error_t cli_cmd_crash(uint32_t argc, const uint8_t **argv, cli_call_state_t state) {
+    static crash_dump_t dump;
+    static uint32_t line_n;
+    error_t result;
+
+
+    if (state == CLI_CALL_FIRST) {
+        if (argc != 1) return E_INVALID_ARG;
+        if (!crash_dump_read(&dump)) {
+            cli_printf("No crash since power-up");
+            return E_OK;
+        }
+        line_n = 0;
+        return E_ASYNC_WAIT;
+    }
+    if (state == CLI_CALL_REPEATED) {
+        switch (line_n) {
+            case 0:
+                result = cli_printf_async("pc = 0x%08X, lr = 0x%08X, xpsr = 0x%08X, sp = 0x%08X", dump.pc, dump.lr, dump.xpsr, dump.sp);
+                break;
+            case 1:
+                result = cli_printf_async("\r\nr0 = 0x%08X, r1 = 0x%08X, r2 = 0x%08X, r3 = 0x%08X, r12 = 0x%08X", dump.r0, dump.r1, dump.r2, dump.r3, dump.r12);
+                break;
+            case 2:
+                result = cli_printf_async("\r\ntime_ms = %d, fail = 0x%04X, state = %d", dump.time_ms, dump.fail_code, dump.so_state);
+                break;
+            default:
+                return E_OK;
+        }
+        if (result == E_OK) line_n++;
+        return E_ASYNC_WAIT;
+    }
+    return E_OK;
+}
+
+
+
+static error_t cli_cmd_vdda(uint32_t argc, const uint8_t **argv, cli_call_state_t state) {
+    vdda_monitor_stat_t stat;
+
+
+    if (argc == 2) {
+        if (!pars_is_there_template_in_string(argv[1], "clr")) return E_INVALID_ARG;
+        vdda_monitor_reset_stat();
+        return E_OK;
+    }
+    if (argc != 1) return E_INVALID_ARG;
+
+    vdda_monitor_get_stat(&stat);
+    return cli_printf_async("vdda_mv = %d, min = %d, avg = %d, max = %d, heater_on_min = %d, sags = %d, heater_sags = %d",
+                            stat.vdda_mv, stat.min_mv, stat.avg_mv, stat.max_mv, stat.heater_on_min_mv, stat.sags_qty, stat.heater_sags_qty);
+}
+
+
 
 static bool pars_string_to_s32_and_check(const uint8_t *str, int32_t *digit, int32_t min, int32_t max) {
     if (!pars_string_to_s32(str, digit)) return false;
@@ -0,0 +1,114 @@
+//  ***************************************************************************
+/// @file    crash_dump.c
+/// @note    Snapshot survives reset, but not power loss. The first boot after
+///          crash reports it once by WARNING_CODE_HARD_FAULT_RESET (PC is
+///          journal context, so it is stored to FLASH too).
+//  ***************************************************************************
+#include "crash_dump.h"
+#include <stddef.h>
+#include <string.h>
+#include "common/mcu.h"
+#include "common/crc_calc.h"
+#include "hal/systimer.h"
+#include "error_handling.h"
+#include "system_operation.h"
+
+
+#define CRASH_DUMP_MAGIC            (0xDEADFA17)
+#define CRASH_DUMP_FLAG_NEW         (1 << 0)   // not reported yet
+
+#define XPSR_STACK_ALIGN_Msk        (1 << 9)   // frame was aligned by extra word
+
+
+typedef struct {
+    uint32_t magic;
+    uint32_t flags;
+    crash_dump_t dump;
+    uint32_t crc;
+} crash_dump_storage_t;
+
+
+static __no_init crash_dump_storage_t crash_dump_storage;
+
+
+static bool is_storage_valid(void);
+static uint32_t storage_crc(void);
+
+
+
+
+//  ***************************************************************************
+/// @brief  Check snapshot after reset, report new one
+/// @param  none
+/// @return none
+/// @note   Should be called after error_handling_init()
+//  ***************************************************************************
+void crash_dump_init(void) {
+    if (!is_storage_valid()) {
+        memset(&crash_dump_storage, 0, sizeof(crash_dump_storage));
+        return;
+    }
+
+    if (crash_dump_storage.flags & CRASH_DUMP_FLAG_NEW) {
+        eh_set_warn_hard_fault_reset(crash_dump_storage.dump.pc);
+        crash_dump_storage.flags &= ~CRASH_DUMP_FLAG_NEW;
+        crash_dump_storage.crc = storage_crc();
+    }
+}
+
+
+//  ***************************************************************************
+/// @brief  Save snapshot and reset MCU
+/// @param  stack_frame - exception stack frame: r0, r1, r2, r3, r12, lr, pc, xpsr
+/// @return never
+/// @note   Called from HardFault_Handler, uses only main stack
+//  ***************************************************************************
+void crash_dump_hard_fault(const uint32_t *stack_frame) {
+    crash_dump_t *dump = &crash_dump_storage.dump;
+
+
+    dump->r0 = stack_frame[0];
+    dump->r1 = stack_frame[1];
+    dump->r2 = stack_frame[2];
+    dump->r3 = stack_frame[3];
+    dump->r12 = stack_frame[4];
+    dump->lr = stack_frame[5];
+    dump->pc = stack_frame[6];
+    dump->xpsr = stack_frame[7];
+    dump->sp = (uint32_t)&stack_frame[8] + ((dump->xpsr & XPSR_STACK_ALIGN_Msk) ? 4 : 0);
+    dump->time_ms = get_time_ms();
+    dump->fail_code = fail_code;
+    dump->so_state = system_operation_get_state();
+    dump->reserved = 0;
+
+    crash_dump_storage.magic = CRASH_DUMP_MAGIC;
+    crash_dump_storage.flags = CRASH_DUMP_FLAG_NEW;
+    crash_dump_storage.crc = storage_crc();
+
+    NVIC_SystemReset();
+}
+
+
+//  ***************************************************************************
+/// @brief  Read the last crash snapshot
+/// @param  dump - pointer, can't be NULL
+/// @retval dump
+/// @return true - success, false - no crash since power-up
+//  ***************************************************************************
+bool crash_dump_read(crash_dump_t *dump) {
+    if (!is_storage_valid()) return false;
+    *dump = crash_dump_storage.dump;
+    return true;
+}
+
+
+
+
+static bool is_storage_valid(void) {
+    return ((crash_dump_storage.magic == CRASH_DUMP_MAGIC) && (crash_dump_storage.crc == storage_crc()));
+}
+
+
+static uint32_t storage_crc(void) {
+    return crc_sw_clac(&crc_16_modbus, (const uint8_t*)&crash_dump_storage, offsetof(crash_dump_storage_t, crc));
+}
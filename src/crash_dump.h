@@ -0,0 +1,37 @@
+//  ***************************************************************************
+/// @file    crash_dump.h
+/// @brief   HardFault snapshot kept in no-init RAM across reset
+//  ***************************************************************************
+#ifndef _CRASH_DUMP_H_
+#define _CRASH_DUMP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+typedef struct {
+    // Exception stack frame
+    uint32_t r0;
+    uint32_t r1;
+    uint32_t r2;
+    uint32_t r3;
+    uint32_t r12;
+    uint32_t lr;
+    uint32_t pc;
+    uint32_t xpsr;
+    // Key state
+    uint32_t sp;             // before exception
+    uint32_t time_ms;
+    uint16_t fail_code;
+    uint8_t  so_state;       // system_operation_get_state()
+    uint8_t  reserved;
+} crash_dump_t;
+
+
+extern void crash_dump_init(void);
+extern void crash_dump_hard_fault(const uint32_t *stack_frame);
+
+extern bool crash_dump_read(crash_dump_t *dump);
+
+
+#endif   // _CRASH_DUMP_H_
@@ -0,0 +1,211 @@
+//  ***************************************************************************
+/// @file    eeprom_emul.c
+/// @note    Two pages, one of them is active. Every write appends a record
+///          (u16 value, u16 ID) to the active page, the last record with the
+///          ID is actual. When the active page is full, the actual values are
+///          compacted to the other page. Page states are stored in the first
+///          halfword of the page: ERASED -> RECEIVE (compaction in progress)
+///          -> VALID. Interrupted compaction is recovered at init.
+//  ***************************************************************************
+#include "eeprom_emul.h"
+
+
+#define PAGE_STATUS_ERASED      (0xFFFF)
+#define PAGE_STATUS_RECEIVE     (0xEEEE)
+#define PAGE_STATUS_VALID       (0x0000)
+
+#define RECORD_SIZE             (4)     // u16 value, u16 ID (written last)
+#define RECORD_ID_OFFSET        (2)
+#define RECORD_ID_ERASED        (0xFFFF)
+#define PAGE_HEADER_SIZE        (RECORD_SIZE)
+
+#define PAGES_QTY               (FLASH_EE_PAGES_QTY)
+
+
+static uint32_t ee_active_page;
+static uint32_t ee_write_offset;
+static uint16_t ee_values[EEPROM_EMUL_VARS_QTY];
+static uint32_t ee_present_mask;
+
+
+static uint32_t get_page_address(uint32_t page);
+static uint16_t get_page_status(uint32_t page);
+static bool set_page_status(uint32_t page, uint16_t status);
+static void load_page(uint32_t page);
+static bool append_record(uint16_t id, uint16_t value);
+static bool compact(void);
+static bool format(void);
+
+
+
+
+//  ***************************************************************************
+/// @brief  Init EEPROM emulation: recover pages state and load variables
+/// @param  none
+/// @return true - success, false - fail
+//  ***************************************************************************
+bool eeprom_emul_init(void) {
+    uint16_t status_0, status_1;
+
+
+    ee_present_mask = 0;
+    status_0 = get_page_status(0);
+    status_1 = get_page_status(1);
+
+    // Normal state
+    if ((status_0 == PAGE_STATUS_VALID) && (status_1 == PAGE_STATUS_ERASED)) {
+        load_page(0);
+        return true;
+    }
+    if ((status_1 == PAGE_STATUS_VALID) && (status_0 == PAGE_STATUS_ERASED)) {
+        load_page(1);
+        return true;
+    }
+
+    // Compaction was interrupted while copying: redo it from the valid page
+    if ((status_0 == PAGE_STATUS_VALID) && (status_1 == PAGE_STATUS_RECEIVE)) {
+        load_page(0);
+        return compact();
+    }
+    if ((status_1 == PAGE_STATUS_VALID) && (status_0 == PAGE_STATUS_RECEIVE)) {
+        load_page(1);
+        return compact();
+    }
+
+    // Compaction was interrupted after copying: the old page is erased already
+    if ((status_0 == PAGE_STATUS_RECEIVE) && (status_1 == PAGE_STATUS_ERASED)) {
+        load_page(0);
+        return set_page_status(0, PAGE_STATUS_VALID);
+    }
+    if ((status_1 == PAGE_STATUS_RECEIVE) && (status_0 == PAGE_STATUS_ERASED)) {
+        load_page(1);
+        return set_page_status(1, PAGE_STATUS_VALID);
+    }
+
+    // Blank or broken storage
+    return format();
+}
+
+
+//  ***************************************************************************
+/// @brief  Read variable
+/// @param  id - 0..(EEPROM_EMUL_VARS_QTY - 1)
+/// @param  value - pointer, can't be NULL
+/// @retval value
+/// @return true - success, false - variable has never been written
+//  ***************************************************************************
+bool eeprom_emul_read(uint16_t id, uint16_t *value) {
+    if (id >= EEPROM_EMUL_VARS_QTY) return false;
+    if ((ee_present_mask & (1UL << id)) == 0) return false;
+    *value = ee_values[id];
+    return true;
+}
+
+
+//  ***************************************************************************
+/// @brief  Write variable
+/// @param  id - 0..(EEPROM_EMUL_VARS_QTY - 1)
+/// @param  value
+/// @return true - success, false - fail
+/// @note   Blocking: may compact (erase pages). The same value isn't rewritten.
+//  ***************************************************************************
+bool eeprom_emul_write(uint16_t id, uint16_t value) {
+    if (id >= EEPROM_EMUL_VARS_QTY) return false;
+    if ((ee_present_mask & (1UL << id)) && (ee_values[id] == value)) return true;
+
+    ee_values[id] = value;
+    ee_present_mask |= (1UL << id);
+
+    if (ee_write_offset >= INT_FLASH_PAGE_SIZE) return compact();
+    return append_record(id, value);
+}
+
+
+
+
+static uint32_t get_page_address(uint32_t page) {
+    return FLASH_EE_BASE_ADDRESS + (page * INT_FLASH_PAGE_SIZE);
+}
+
+
+static uint16_t get_page_status(uint32_t page) {
+    return *((uint16_t*)get_page_address(page));
+}
+
+
+static bool set_page_status(uint32_t page, uint16_t status) {
+    return int_flash_driver_write_bytes(get_page_address(page), (uint8_t*)&status, 2);
+}
+
+
+static void load_page(uint32_t page) {
+    uint32_t page_address, offset;
+    uint16_t value, id;
+
+
+    ee_active_page = page;
+    page_address = get_page_address(page);
+
+    // Write position is after the last used record. Broken record (power loss) is skipped.
+    ee_write_offset = PAGE_HEADER_SIZE;
+    for (offset = PAGE_HEADER_SIZE; offset < INT_FLASH_PAGE_SIZE; offset += RECORD_SIZE) {
+        value = *((uint16_t*)(page_address + offset));
+        id = *((uint16_t*)(page_address + offset + RECORD_ID_OFFSET));
+        if ((value != 0xFFFF) || (id != RECORD_ID_ERASED)) ee_write_offset = offset + RECORD_SIZE;
+        if (id < EEPROM_EMUL_VARS_QTY) {
+            ee_values[id] = value;
+            ee_present_mask |= (1UL << id);
+        }
+    }
+}
+
+
+static bool append_record(uint16_t id, uint16_t value) {
+    uint32_t record_address;
+
+
+    record_address = get_page_address(ee_active_page) + ee_write_offset;
+    ee_write_offset += RECORD_SIZE;
+    if (!int_flash_driver_write_bytes(record_address, (uint8_t*)&value, 2)) return false;
+    return int_flash_driver_write_bytes((record_address + RECORD_ID_OFFSET), (uint8_t*)&id, 2);
+}
+
+
+//  ***************************************************************************
+/// @brief  Copy actual values (from RAM) to the other page and switch to it
+//  ***************************************************************************
+static bool compact(void) {
+    uint32_t new_page, old_page;
+    uint16_t id;
+
+
+    old_page = ee_active_page;
+    new_page = (ee_active_page + 1) % PAGES_QTY;
+
+    if (!int_flash_driver_erase_page(get_page_address(new_page))) return false;
+    if (!set_page_status(new_page, PAGE_STATUS_RECEIVE)) return false;
+
+    ee_active_page = new_page;
+    ee_write_offset = PAGE_HEADER_SIZE;
+    for (id = 0; id < EEPROM_EMUL_VARS_QTY; id++) {
+        if ((ee_present_mask & (1UL << id)) == 0) continue;
+        if (!append_record(id, ee_values[id])) return false;
+    }
+
+    if (!int_flash_driver_erase_page(get_page_address(old_page))) return false;
+    return set_page_status(new_page, PAGE_STATUS_VALID);
+}
+
+
+static bool format(void) {
+    uint32_t page;
+
+
+    for (page = 0; page < PAGES_QTY; page++) {
+        if (!int_flash_driver_erase_page(get_page_address(page))) return false;
+    }
+    ee_active_page = 0;
+    ee_write_offset = PAGE_HEADER_SIZE;
+    ee_present_mask = 0;
+    return set_page_status(0, PAGE_STATUS_VALID);
+}
@@ -0,0 +1,25 @@
+//  ***************************************************************************
+/// @file    eeprom_emul.h
+/// @brief   EEPROM emulation in FLASH (16-bit variables with IDs)
+//  ***************************************************************************
+#ifndef _EEPROM_EMUL_H_
+#define _EEPROM_EMUL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hal/int_flash_driver.h"
+#include "flash.h"
+
+
+#define EEPROM_EMUL_VARS_QTY    (16)    // IDs 0..(EEPROM_EMUL_VARS_QTY - 1)
+
+
+extern bool eeprom_emul_init(void);
+
+extern bool eeprom_emul_read(uint16_t id, uint16_t *value);
+extern bool eeprom_emul_write(uint16_t id, uint16_t value);
+
+
+#endif   // _EEPROM_EMUL_H_
@@ -2,12 +2,18 @@
 /// @file    error_handling.c
 //  ***************************************************************************
 #include "error_handling.h"
+#include "event_journal.h"
 
 uint16_t fail_code;
 uint16_t warning_code;
 error_t eh_fw_error_extended_code;
 
 
+static void eh_set_fail(uint16_t flag, uint32_t context);
+static void eh_set_warn(uint16_t flag, uint32_t context);
+
+
+
 //  ***************************************************************************
 /// @brief      Error handling module init
 /// @param      none
@@ -26,25 +32,88 @@ void eh_set_fail_fw_error(error_t extended_code) {
     fail_code |= FAIL_CODE_FW_ERROR;
     if (ERROR_GET_SOFTWARE_FLAG(extended_code)) eh_set_fail_fw_error(extended_code);
     if (eh_fw_error_extended_code == E_OK) eh_fw_error_extended_code = extended_code;
+    event_journal_add(EVENT_JOURNAL_SOURCE_FAIL, FAIL_CODE_FW_ERROR, extended_code, 0);
 }
 
 void eh_set_fail_cfg_error(void) {
-    fail_code |= FAIL_CODE_CFG_ERROR;
+    eh_set_fail(FAIL_CODE_CFG_ERROR, 0);
 }
 
 void eh_set_fail_ext_oscillator_error(void) {
-    fail_code |= FAIL_CODE_EXT_OSCILLATOR_ERROR;
+    eh_set_fail(FAIL_CODE_EXT_OSCILLATOR_ERROR, 0);
 }
 
-void eh_set_fail_mcu_overtemperature(void) {
-    fail_code |= FAIL_CODE_MCU_OVERTEMPERATURE;
+void eh_set_fail_mcu_overtemperature(uint32_t temperature_c) {
+    eh_set_fail(FAIL_CODE_MCU_OVERTEMPERATURE, temperature_c);
 }
 
 void eh_set_fail_lcd_error(void) {
-    fail_code |= FAIL_CODE_LCD_ERROR;
+    eh_set_fail(FAIL_CODE_LCD_ERROR, 0);
+}
+
+void eh_set_fail_heater_sensor_error(uint32_t temperature_c_x10) {
+    eh_set_fail(FAIL_CODE_HEATER_SENSOR_ERROR, temperature_c_x10);
+}
+
+void eh_set_fail_heater_overtemperature(uint32_t temperature_c_x10) {
+    eh_set_fail(FAIL_CODE_HEATER_OVERTEMPERATURE, temperature_c_x10);
+}
+
+void eh_set_fail_heater_not_heating(uint32_t temperature_c_x10) {
+    eh_set_fail(FAIL_CODE_HEATER_NOT_HEATING, temperature_c_x10);
+}
+
+void eh_set_fail_heater_runaway(uint32_t temperature_c_x10) {
+    eh_set_fail(FAIL_CODE_HEATER_RUNAWAY, temperature_c_x10);
+}
+
+
+void eh_set_warn_err_wdt_reset(uint32_t reset_flags) {
+    eh_set_warn(WARNING_CODE_ERR_WDT_RESET, reset_flags);
+}
+
+void eh_set_warn_profile_error(uint32_t invalid_profiles_mask) {
+    eh_set_warn(WARNING_CODE_PROFILE_ERROR, invalid_profiles_mask);
+}
+
+void eh_clear_warn_profile_error(void) {
+    warning_code &= ~WARNING_CODE_PROFILE_ERROR;
 }
 
+void eh_set_warn_hard_fault_reset(uint32_t pc) {
+    eh_set_warn(WARNING_CODE_HARD_FAULT_RESET, pc);
+}
+
+void eh_set_warn_vdda_sag(uint32_t context) {
+    eh_set_warn(WARNING_CODE_VDDA_SAG, context);
+}
+
+
+
+
+//  ***************************************************************************
+/// @brief      Set fail flag, journal it once
+/// @param      flag - FAIL_CODE_x
+/// @param      context - event specific value for journal
+/// @return     none
+//  ***************************************************************************
+static void eh_set_fail(uint16_t flag, uint32_t context) {
+    if (fail_code & flag) return;
+
+    fail_code |= flag;
+    event_journal_add(EVENT_JOURNAL_SOURCE_FAIL, flag, E_OK, context);
+}
+
+
+//  ***************************************************************************
+/// @brief      Set warning flag, journal it once
+/// @param      flag - WARNING_CODE_x
+/// @param      context - event specific value for journal
+/// @return     none
+//  ***************************************************************************
+static void eh_set_warn(uint16_t flag, uint32_t context) {
+    if (warning_code & flag) return;
 
-void eh_set_warn_err_wdt_reset(void) {
-    warning_code |= WARNING_CODE_ERR_WDT_RESET;
+    warning_code |= flag;
+    event_journal_add(EVENT_JOURNAL_SOURCE_WARNING, flag, E_OK, context);
 }
@@ -15,8 +15,15 @@
 #define FAIL_CODE_EXT_OSCILLATOR_ERROR    (1 << 2)
 #define FAIL_CODE_MCU_OVERTEMPERATURE     (1 << 3)
 #define FAIL_CODE_LCD_ERROR               (1 << 4)
+#define FAIL_CODE_HEATER_SENSOR_ERROR     (1 << 5)
+#define FAIL_CODE_HEATER_OVERTEMPERATURE  (1 << 6)
+#define FAIL_CODE_HEATER_NOT_HEATING      (1 << 7)
+#define FAIL_CODE_HEATER_RUNAWAY          (1 << 8)
 
 #define WARNING_CODE_ERR_WDT_RESET        (1 << 0)
+#define WARNING_CODE_PROFILE_ERROR        (1 << 1)
+#define WARNING_CODE_HARD_FAULT_RESET     (1 << 2)
+#define WARNING_CODE_VDDA_SAG             (1 << 3)
 
 
 
@@ -32,10 +39,18 @@ extern void error_handling_init(void);
 extern void eh_set_fail_fw_error(error_t extended_code);
 extern void eh_set_fail_cfg_error(void);
 extern void eh_set_fail_ext_oscillator_error(void);
-extern void eh_set_fail_mcu_overtemperature(void);
+extern void eh_set_fail_mcu_overtemperature(uint32_t temperature_c);
 extern void eh_set_fail_lcd_error(void);
-
-extern void eh_set_warn_err_wdt_reset(void);
+extern void eh_set_fail_heater_sensor_error(uint32_t temperature_c_x10);
+extern void eh_set_fail_heater_overtemperature(uint32_t temperature_c_x10);
+extern void eh_set_fail_heater_not_heating(uint32_t temperature_c_x10);
+extern void eh_set_fail_heater_runaway(uint32_t temperature_c_x10);
+
+extern void eh_set_warn_err_wdt_reset(uint32_t reset_flags);
+extern void eh_set_warn_profile_error(uint32_t invalid_profiles_mask);
+extern void eh_clear_warn_profile_error(void);
+extern void eh_set_warn_hard_fault_reset(uint32_t pc);
+extern void eh_set_warn_vdda_sag(uint32_t context);
 
 
 #endif  // _ERROR_HANDLING_H_
@@ -0,0 +1,169 @@
+//  ***************************************************************************
+/// @file    event_journal.c
+/// @note    Events are added to RAM ring at once (from interrupts too) and are
+///          stored to FLASH as @ref flash_log records from main loop. At init
+///          the ring is filled by the newest stored events, so the journal
+///          survives reboots.
+//  ***************************************************************************
+#include "event_journal.h"
+#include <string.h>
+#include "common/mcu.h"
+#include "common/le_bytes.h"
+#include "hal/systimer.h"
+#include "flash_log.h"
+
+
+// Record data layout
+#define EVENT_DATA_TIME_OFFSET          (0)    // u32, ms
+#define EVENT_DATA_CODE_OFFSET          (4)    // u32, error_t
+#define EVENT_DATA_CONTEXT_OFFSET       (8)    // u32
+#define EVENT_DATA_FLAG_OFFSET          (12)   // u16
+#define EVENT_DATA_SOURCE_OFFSET        (14)   // u8
+
+
+static event_journal_entry_t journal[EVENT_JOURNAL_SIZE];
+static uint32_t journal_head;        // next entry to write
+static uint32_t journal_qty;
+static uint32_t journal_pending_qty; // the newest entries not stored to FLASH yet
+
+
+static void push_entry(const event_journal_entry_t *entry);
+
+
+
+
+//  ***************************************************************************
+/// @brief  Init journal: load the newest events from FLASH log
+/// @param  none
+/// @return none
+/// @note   Should be called after flash_log_init() and before any event
+//  ***************************************************************************
+void event_journal_init(void) {
+    flash_log_record_t record;
+    event_journal_entry_t entry;
+    uint32_t record_n;
+
+
+    journal_head = 0;
+    journal_qty = 0;
+    journal_pending_qty = 0;
+
+    for (record_n = 0; record_n < flash_log_get_records_qty(); record_n++) {
+        if (!flash_log_read(record_n, &record)) continue;
+        if (record.type != FLASH_LOG_TYPE_EVENT) continue;
+
+        entry.time_ms = le_get_u32(&record.data[EVENT_DATA_TIME_OFFSET]);
+        entry.code = le_get_u32(&record.data[EVENT_DATA_CODE_OFFSET]);
+        entry.context = le_get_u32(&record.data[EVENT_DATA_CONTEXT_OFFSET]);
+        entry.flag = le_get_u16(&record.data[EVENT_DATA_FLAG_OFFSET]);
+        entry.source = record.data[EVENT_DATA_SOURCE_OFFSET];
+        entry.is_prev_boot = true;
+        push_entry(&entry);
+    }
+}
+
+
+//  ***************************************************************************
+/// @brief  Store pending events to FLASH, one per call
+/// @param  none
+/// @return none
+/// @note   Blocking: may erase FLASH page. Event is dropped if FLASH fails,
+///         it stays in RAM journal.
+//  ***************************************************************************
+void event_journal_process(void) {
+    uint8_t data[FLASH_LOG_RECORD_DATA_SIZE];
+    event_journal_entry_t entry;
+    uint32_t primask;
+
+
+    if (journal_pending_qty == 0) return;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    entry = journal[(journal_head + EVENT_JOURNAL_SIZE - journal_pending_qty) % EVENT_JOURNAL_SIZE];
+    __set_PRIMASK(primask);
+
+    memset(data, 0, sizeof(data));
+    le_put_u32(&data[EVENT_DATA_TIME_OFFSET], entry.time_ms);
+    le_put_u32(&data[EVENT_DATA_CODE_OFFSET], entry.code);
+    le_put_u32(&data[EVENT_DATA_CONTEXT_OFFSET], entry.context);
+    le_put_u16(&data[EVENT_DATA_FLAG_OFFSET], entry.flag);
+    data[EVENT_DATA_SOURCE_OFFSET] = entry.source;
+    flash_log_append(FLASH_LOG_TYPE_EVENT, data);
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (journal_pending_qty > 0) journal_pending_qty--;
+    __set_PRIMASK(primask);
+}
+
+
+//  ***************************************************************************
+/// @brief  Add event to journal
+/// @param  source - EVENT_JOURNAL_SOURCE_x
+/// @param  flag - FAIL_CODE_x / WARNING_CODE_x
+/// @param  code - extended error code, E_OK if not applicable
+/// @param  context - event specific value
+/// @return none
+/// @note   Can be called from interrupts
+//  ***************************************************************************
+void event_journal_add(uint8_t source, uint16_t flag, error_t code, uint32_t context) {
+    event_journal_entry_t entry;
+    uint32_t primask;
+
+
+    entry.time_ms = get_time_ms();
+    entry.code = code;
+    entry.context = context;
+    entry.flag = flag;
+    entry.source = source;
+    entry.is_prev_boot = false;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    push_entry(&entry);
+    if (journal_pending_qty < EVENT_JOURNAL_SIZE) journal_pending_qty++;
+    __set_PRIMASK(primask);
+}
+
+
+//  ***************************************************************************
+/// @brief  Get journal entries qty
+/// @param  none
+/// @return entries qty, use it as @ref event_journal_read entry_n limit
+//  ***************************************************************************
+uint32_t event_journal_get_qty(void) {
+    return journal_qty;
+}
+
+
+//  ***************************************************************************
+/// @brief  Read journal entry
+/// @param  entry_n - entry number from the oldest one
+/// @param  entry - pointer, can't be NULL
+/// @retval entry
+/// @return true - success, false - entry is absent
+//  ***************************************************************************
+bool event_journal_read(uint32_t entry_n, event_journal_entry_t *entry) {
+    uint32_t primask;
+    bool result = false;
+
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (entry_n < journal_qty) {
+        *entry = journal[(journal_head + EVENT_JOURNAL_SIZE - journal_qty + entry_n) % EVENT_JOURNAL_SIZE];
+        result = true;
+    }
+    __set_PRIMASK(primask);
+    return result;
+}
+
+
+
+
+static void push_entry(const event_journal_entry_t *entry) {
+    journal[journal_head] = *entry;
+    journal_head = (journal_head + 1) % EVENT_JOURNAL_SIZE;
+    if (journal_qty < EVENT_JOURNAL_SIZE) journal_qty++;
+}
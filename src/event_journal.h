@@ -0,0 +1,38 @@
+//  ***************************************************************************
+/// @file    event_journal.h
+/// @brief   Fault and warning events journal with persisted tail in FLASH
+//  ***************************************************************************
+#ifndef _EVENT_JOURNAL_H_
+#define _EVENT_JOURNAL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "common/error.h"
+
+
+#define EVENT_JOURNAL_SIZE              (8)    // entries in RAM, the oldest is overwritten, EVENT_INDEX max in registers.yaml
+
+// Event sources
+#define EVENT_JOURNAL_SOURCE_FAIL       (1)    // flag is FAIL_CODE_x
+#define EVENT_JOURNAL_SOURCE_WARNING    (2)    // flag is WARNING_CODE_x
+
+
+typedef struct {
+    uint32_t time_ms;       // since power-up of the boot event happened in
+    error_t  code;          // extended code, E_OK if not applicable
+    uint32_t context;       // event specific value
+    uint16_t flag;
+    uint8_t  source;        // EVENT_JOURNAL_SOURCE_x
+    bool     is_prev_boot;  // loaded from FLASH at init
+} event_journal_entry_t;
+
+
+extern void event_journal_init(void);
+extern void event_journal_process(void);
+
+extern void event_journal_add(uint8_t source, uint16_t flag, error_t code, uint32_t context);
+extern uint32_t event_journal_get_qty(void);
+extern bool event_journal_read(uint32_t entry_n, event_journal_entry_t *entry);
+
+
+#endif   // _EVENT_JOURNAL_H_
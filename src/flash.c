@@ -1,17 +1,60 @@
 //  ***************************************************************************
 /// @file    flash.c
+/// @note    Writes go to RAM shadow only. Shadow is committed to FLASH by
+///          @ref flash_commit call or after FLASH_COMMIT_IDLE_TIMEOUT_MS
+///          without writes. Idle commit is deferred while held by
+///          @ref flash_set_idle_commit_hold (page erase stalls CPU for tens
+///          of ms). Config has two
+///          copies (A/B): commit writes the inactive copy with incremented
+///          sequence number, verifies CRC and only then switches to it, so
+///          power loss keeps the previous copy.
 //  ***************************************************************************
 #include "flash.h"
 
 
-bool flash_init(void) {
-    uint8_t *flash_page_ptr = (uint8_t*)FLASH_REAL_BASE_PAGE_ADDRESS;
-    uint32_t crc32_calc, crc32_real;
+#define FLASH_COPIES_QTY    (2)
+#define FLASH_SEQ_ERASED    (0xFFFFFFFF)    // copy written before A/B storage
+
+
+static const uint32_t flash_copies_addresses[FLASH_COPIES_QTY] = {FLASH_REAL_BASE_PAGE_ADDRESS, FLASH_REAL_ALT_PAGE_ADDRESS};
+static uint32_t flash_active_copy;
+static uint32_t flash_active_seq;
+static uint8_t flash_shadow[FLASH_SHADOW_SIZE];
+static bool is_flash_dirty;
+static bool is_idle_commit_hold = false;
+static timer_t flash_idle_timer;
+
+
+static bool write_copy(uint32_t copy);
+static bool is_copy_valid(uint32_t copy, uint32_t *seq);
 
 
-    crc32_calc = crc_hw_clac(&crc_hw_32_posix, flash_page_ptr, FLASH_SIZE_FOR_CRC);
-    flash_read_u32(FLASH_CRC32_ADDR, &crc32_real);
-    if (crc32_calc != crc32_real) {
+
+
+//  ***************************************************************************
+/// @brief  Select the newest valid config copy and load it to RAM shadow
+/// @param  none
+/// @return true - success, false - no valid copy (cfg fail is set)
+//  ***************************************************************************
+bool flash_init(void) {
+    uint32_t copy, seq;
+    bool is_valid_copy_found = false;
+
+
+    is_flash_dirty = false;
+    flash_active_copy = 0;
+    flash_active_seq = 0;
+    for (copy = 0; copy < FLASH_COPIES_QTY; copy++) {
+        if (!is_copy_valid(copy, &seq)) continue;
+        if (!is_valid_copy_found || (seq > flash_active_seq)) {
+            flash_active_copy = copy;
+            flash_active_seq = seq;
+            is_valid_copy_found = true;
+        }
+    }
+
+    int_flash_driver_read_bytes(flash_copies_addresses[flash_active_copy], flash_shadow, FLASH_SHADOW_SIZE);
+    if (!is_valid_copy_found) {
         eh_set_fail_cfg_error();
         return false;
     }
@@ -20,26 +63,89 @@ bool flash_init(void) {
 }
 
 
-bool flash_update_crc(void) {
-    uint8_t *flash_page_ptr = (uint8_t*)FLASH_REAL_BASE_PAGE_ADDRESS;
-    uint32_t crc32_calc;
+void flash_process(void) {
+    if (!is_flash_dirty) return;
+    if (!timer_triggered(flash_idle_timer)) return;
+    if (is_idle_commit_hold) return;
+    flash_commit();
+}
 
 
-    crc32_calc = crc_hw_clac(&crc_hw_32_posix, flash_page_ptr, FLASH_SIZE_FOR_CRC);
-    flash_write_u32(FLASH_CRC32_ADDR, crc32_calc);
+//  ***************************************************************************
+/// @brief  Commit RAM shadow to inactive config copy and switch to it
+/// @param  none
+/// @return true - success, false - fail (active copy isn't changed, commit
+///         is retried after FLASH_COMMIT_IDLE_TIMEOUT_MS)
+//  ***************************************************************************
+bool flash_commit(void) {
+    if (!write_copy((flash_active_copy + 1) % FLASH_COPIES_QTY)) {
+        is_flash_dirty = true;
+        flash_idle_timer = timer_start_ms(FLASH_COMMIT_IDLE_TIMEOUT_MS);
+        return false;
+    }
+    is_flash_dirty = false;
     return true;
 }
 
 
-bool flash_erase(void) {
-    uint32_t i, addr;
+//  ***************************************************************************
+/// @brief  Hold idle commit, e.g. while process is running
+/// @param  is_hold - true - hold, false - pending commit is done by the next
+///         flash_process() call
+/// @return none
+/// @note   flash_commit() call isn't affected
+//  ***************************************************************************
+void flash_set_idle_commit_hold(bool is_hold) {
+    is_idle_commit_hold = is_hold;
+}
 
 
-    addr = FLASH_REAL_BASE_PAGE_ADDRESS;
-    for (i = 0; i < FLASH_PAGES_QTY; i++) {
-        if (!int_flash_driver_erase_page(addr)) return false;
-        addr += INT_FLASH_PAGE_SIZE;
-    }
+bool flash_is_dirty(void) {
+    return is_flash_dirty;
+}
+
+
+//  ***************************************************************************
+/// @brief  Drop not committed writes: reload RAM shadow from active copy
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void flash_discard(void) {
+    int_flash_driver_read_bytes(flash_copies_addresses[flash_active_copy], flash_shadow, FLASH_SHADOW_SIZE);
+    is_flash_dirty = false;
+}
+
+
+//  ***************************************************************************
+/// @brief  Get memory-mapped view of committed data (active copy)
+/// @param  none
+/// @return pointer to data, valid till the next commit (see @ref flash_get_active_seq)
+//  ***************************************************************************
+const uint8_t *flash_get_data_ptr(void) {
+    return (const uint8_t*)flash_copies_addresses[flash_active_copy];
+}
+
+
+//  ***************************************************************************
+/// @brief  Get active copy sequence number
+/// @param  none
+/// @return sequence number, it's changed by every commit
+//  ***************************************************************************
+uint32_t flash_get_active_seq(void) {
+    return flash_active_seq;
+}
+
+
+//  ***************************************************************************
+/// @brief  Erase data
+/// @param  none
+/// @return true - success, false - fail
+/// @note   RAM shadow is erased, FLASH is erased at commit
+//  ***************************************************************************
+bool flash_erase(void) {
+    memset(flash_shadow, 0xFF, FLASH_SHADOW_SIZE);
+    is_flash_dirty = true;
+    flash_idle_timer = timer_start_ms(FLASH_COMMIT_IDLE_TIMEOUT_MS);
     return true;
 }
 
@@ -55,9 +161,11 @@ bool flash_write_u32(uint32_t address, uint32_t data) {
 
 
 bool flash_write_bytes(uint32_t address, const uint8_t *data, uint32_t data_size) {
-    if ((address + data_size) > FLASH_SIZE) return false;
-    address += FLASH_REAL_BASE_PAGE_ADDRESS;
-    return int_flash_driver_write_bytes(address, data, data_size);
+    if ((address + data_size) > FLASH_SHADOW_SIZE) return false;
+    memcpy(&flash_shadow[address], data, data_size);
+    is_flash_dirty = true;
+    flash_idle_timer = timer_start_ms(FLASH_COMMIT_IDLE_TIMEOUT_MS);
+    return true;
 }
 
 
@@ -77,8 +185,66 @@ bool flash_read_u32(uint32_t address, uint32_t *data) {
 
 
 bool flash_read_bytes(uint32_t address, uint8_t *data, uint32_t data_size) {
+    uint32_t shadow_size;
+
+
     if ((address + data_size) > FLASH_SIZE) return false;
-    address += FLASH_REAL_BASE_PAGE_ADDRESS;
-    int_flash_driver_read_bytes(address, data, data_size);
+
+    // Shadowed area from RAM, the rest (sequence, CRC) from FLASH
+    if (address < FLASH_SHADOW_SIZE) {
+        shadow_size = FLASH_SHADOW_SIZE - address;
+        if (shadow_size > data_size) shadow_size = data_size;
+        memcpy(data, &flash_shadow[address], shadow_size);
+        address += shadow_size;
+        data += shadow_size;
+        data_size -= shadow_size;
+    }
+    if (data_size > 0) {
+        int_flash_driver_read_bytes((address + flash_copies_addresses[flash_active_copy]), data, data_size);
+    }
+    return true;
+}
+
+
+
+
+static bool write_copy(uint32_t copy) {
+    uint32_t address, i, seq, crc32_calc;
+
+
+    seq = flash_active_seq + 1;
+
+    address = flash_copies_addresses[copy];
+    for (i = 0; i < FLASH_PAGES_QTY; i++) {
+        if (!int_flash_driver_erase_page(address)) return false;
+        address += INT_FLASH_PAGE_SIZE;
+    }
+
+    address = flash_copies_addresses[copy];
+    if (!int_flash_driver_write_bytes(address, flash_shadow, FLASH_SHADOW_SIZE)) return false;
+    if (!int_flash_driver_write_bytes((address + FLASH_SEQ_ADDR), (uint8_t*)&seq, 4)) return false;
+    crc32_calc = crc_hw_clac(&crc_hw_32_posix, (uint8_t*)address, FLASH_SIZE_FOR_CRC);
+    if (!int_flash_driver_write_bytes((address + FLASH_CRC32_ADDR), (uint8_t*)&crc32_calc, 4)) return false;
+
+    // Switch only to verified copy
+    if (!is_copy_valid(copy, &seq)) return false;
+    if (memcmp((uint8_t*)address, flash_shadow, FLASH_SHADOW_SIZE) != 0) return false;
+    flash_active_copy = copy;
+    flash_active_seq = seq;
+    return true;
+}
+
+
+static bool is_copy_valid(uint32_t copy, uint32_t *seq) {
+    uint32_t address, crc32_calc, crc32_real;
+
+
+    address = flash_copies_addresses[copy];
+    crc32_calc = crc_hw_clac(&crc_hw_32_posix, (uint8_t*)address, FLASH_SIZE_FOR_CRC);
+    int_flash_driver_read_bytes((address + FLASH_CRC32_ADDR), (uint8_t*)&crc32_real, 4);
+    if (crc32_calc != crc32_real) return false;
+
+    int_flash_driver_read_bytes((address + FLASH_SEQ_ADDR), (uint8_t*)seq, 4);
+    if (*seq == FLASH_SEQ_ERASED) *seq = 0;
     return true;
 }
@@ -9,19 +9,41 @@
 #include <stdbool.h>
 #include "hal/int_flash_driver.h"
 #include "common/crc_calc.h"
+#include "hal/systimer.h"
 #include "error_handling.h"
 
 
-#define FLASH_REAL_BASE_PAGE_ADDRESS (0x08007C00)
-#define FLASH_PAGES_QTY              (1)
+// Two config copies (A/B), the newest valid one is active
+#define FLASH_REAL_BASE_PAGE_ADDRESS (0x08007C00)   // copy A
+#define FLASH_REAL_ALT_PAGE_ADDRESS  (0x08007800)   // copy B
+#define FLASH_PAGES_QTY              (1)            // per copy
+
+// Records log region just below the config pages
+#define FLASH_LOG_BASE_ADDRESS       (0x08007000)
+#define FLASH_LOG_PAGES_QTY          (2)
+
+// EEPROM emulation region below the records log
+#define FLASH_EE_BASE_ADDRESS        (0x08006800)
+#define FLASH_EE_PAGES_QTY           (2)
 
 #define FLASH_SIZE                   (INT_FLASH_PAGE_SIZE * FLASH_PAGES_QTY)
 #define FLASH_SIZE_FOR_CRC           (FLASH_SIZE - 4)
 #define FLASH_CRC32_ADDR             (FLASH_SIZE - 4)
+#define FLASH_SEQ_ADDR               (FLASH_SIZE - 8)   // u32 copy sequence number, under CRC
+
+// RAM shadow of the page data area (registers mapped data), rest of the page is kept erased
+#define FLASH_SHADOW_SIZE            (540)
+#define FLASH_COMMIT_IDLE_TIMEOUT_MS (5000)
 
 
 extern bool flash_init(void);
-extern bool flash_update_crc(void);
+extern void flash_process(void);
+extern bool flash_commit(void);
+extern void flash_set_idle_commit_hold(bool is_hold);
+extern bool flash_is_dirty(void);
+extern void flash_discard(void);
+extern const uint8_t *flash_get_data_ptr(void);
+extern uint32_t flash_get_active_seq(void);
 extern bool flash_erase(void);
 
 extern bool flash_write_u16(uint32_t address, uint16_t data);
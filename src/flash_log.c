@@ -0,0 +1,196 @@
+//  ***************************************************************************
+/// @file    flash_log.c
+/// @note    Log occupies FLASH_LOG_PAGES_QTY pages used as a ring. Records are
+///          appended one after another, when the ring is full the oldest page
+///          is erased, so every page is erased once per FLASH_LOG_RECORDS_PER_PAGE
+///          records (wear levelling). Record order is restored at init by
+///          sequence numbers, broken records (power loss) are skipped by CRC.
+//  ***************************************************************************
+#include "flash_log.h"
+
+
+// Record layout
+#define RECORD_SEQ_OFFSET       (0)    // u32
+#define RECORD_TYPE_OFFSET      (4)    // u8
+#define RECORD_RESERVED_OFFSET  (5)    // u8
+#define RECORD_DATA_OFFSET      (6)    // u8[FLASH_LOG_RECORD_DATA_SIZE]
+#define RECORD_CRC_OFFSET       (22)   // u16, CRC16 modbus
+#define RECORD_CRC_SIZE         (2)
+
+
+static uint32_t log_oldest_slot;
+static uint32_t log_write_slot;
+static uint32_t log_records_qty;
+static uint32_t log_next_seq;
+
+
+static uint32_t get_slot_address(uint32_t slot);
+static bool read_slot(uint32_t slot, flash_log_record_t *record);
+static bool is_slot_erased(uint32_t slot);
+static bool is_page_erased(uint32_t slot);
+
+
+
+
+//  ***************************************************************************
+/// @brief  Init log: find the oldest and the newest records
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void flash_log_init(void) {
+    flash_log_record_t record;
+    uint32_t slot, newest_seq, oldest_seq, newest_slot;
+
+
+    log_records_qty = 0;
+    newest_slot = 0;
+    newest_seq = 0;
+    oldest_seq = UINT32_MAX;
+    log_oldest_slot = 0;
+    for (slot = 0; slot < FLASH_LOG_RECORDS_QTY; slot++) {
+        if (!read_slot(slot, &record)) continue;
+        if ((log_records_qty == 0) || (record.seq > newest_seq)) {
+            newest_seq = record.seq;
+            newest_slot = slot;
+        }
+        if (record.seq < oldest_seq) {
+            oldest_seq = record.seq;
+            log_oldest_slot = slot;
+        }
+        log_records_qty++;
+    }
+
+    if (log_records_qty == 0) {
+        log_write_slot = 0;
+        log_next_seq = 0;
+    }
+    else {
+        log_write_slot = (newest_slot + 1) % FLASH_LOG_RECORDS_QTY;
+        log_next_seq = newest_seq + 1;
+    }
+}
+
+
+//  ***************************************************************************
+/// @brief  Append record to log
+/// @param  type - FLASH_LOG_TYPE_x
+/// @param  data - FLASH_LOG_RECORD_DATA_SIZE bytes, pointer, can't be NULL
+/// @return true - success, false - fail
+/// @note   Blocking: may erase FLASH page
+//  ***************************************************************************
+bool flash_log_append(uint8_t type, const uint8_t *data) {
+    uint8_t raw_record[FLASH_LOG_RECORD_SIZE];
+    uint32_t crc, i, restart_slot, restart_seq;
+
+
+    raw_record[RECORD_SEQ_OFFSET] = (uint8_t)log_next_seq;
+    raw_record[RECORD_SEQ_OFFSET + 1] = (uint8_t)(log_next_seq >> 8);
+    raw_record[RECORD_SEQ_OFFSET + 2] = (uint8_t)(log_next_seq >> 16);
+    raw_record[RECORD_SEQ_OFFSET + 3] = (uint8_t)(log_next_seq >> 24);
+    raw_record[RECORD_TYPE_OFFSET] = type;
+    raw_record[RECORD_RESERVED_OFFSET] = 0;
+    memcpy(&raw_record[RECORD_DATA_OFFSET], data, FLASH_LOG_RECORD_DATA_SIZE);
+    crc = crc_sw_clac(&crc_16_modbus, raw_record, RECORD_CRC_OFFSET);
+    raw_record[RECORD_CRC_OFFSET] = (uint8_t)crc;
+    raw_record[RECORD_CRC_OFFSET + 1] = (uint8_t)(crc >> 8);
+
+    // Find writable slot. Slot may be dirty after power loss during write, it is skipped.
+    for (i = 0; i < FLASH_LOG_RECORDS_QTY; i++) {
+        if (((log_write_slot % FLASH_LOG_RECORDS_PER_PAGE) == 0) && !is_page_erased(log_write_slot)) {
+            if (!int_flash_driver_erase_page(get_slot_address(log_write_slot))) return false;
+            restart_slot = log_write_slot;
+            restart_seq = log_next_seq;
+            flash_log_init();   // the oldest page is dropped: recount records
+            log_write_slot = restart_slot;
+            log_next_seq = restart_seq;
+        }
+        if (is_slot_erased(log_write_slot)) break;
+        log_write_slot = (log_write_slot + 1) % FLASH_LOG_RECORDS_QTY;
+    }
+
+    if (!int_flash_driver_write_bytes(get_slot_address(log_write_slot), raw_record, sizeof(raw_record))) {
+        log_write_slot = (log_write_slot + 1) % FLASH_LOG_RECORDS_QTY;
+        return false;
+    }
+
+    if (log_records_qty == 0) log_oldest_slot = log_write_slot;
+    log_records_qty++;
+    log_write_slot = (log_write_slot + 1) % FLASH_LOG_RECORDS_QTY;
+    log_next_seq++;
+    return true;
+}
+
+
+//  ***************************************************************************
+/// @brief  Get log span size in records (including broken records)
+/// @param  none
+/// @return records qty, use it as @ref flash_log_read record_n limit
+//  ***************************************************************************
+uint32_t flash_log_get_records_qty(void) {
+    if (log_records_qty == 0) return 0;
+    return ((log_write_slot + FLASH_LOG_RECORDS_QTY - log_oldest_slot - 1) % FLASH_LOG_RECORDS_QTY) + 1;
+}
+
+
+//  ***************************************************************************
+/// @brief  Read log record
+/// @param  record_n - record number from the oldest one
+/// @param  record - pointer, can't be NULL
+/// @retval record
+/// @return true - success, false - record is broken or absent
+//  ***************************************************************************
+bool flash_log_read(uint32_t record_n, flash_log_record_t *record) {
+    if (record_n >= flash_log_get_records_qty()) return false;
+    return read_slot((log_oldest_slot + record_n) % FLASH_LOG_RECORDS_QTY, record);
+}
+
+
+
+
+static uint32_t get_slot_address(uint32_t slot) {
+    return FLASH_LOG_BASE_ADDRESS + 
+           ((slot / FLASH_LOG_RECORDS_PER_PAGE) * INT_FLASH_PAGE_SIZE) +
+           ((slot % FLASH_LOG_RECORDS_PER_PAGE) * FLASH_LOG_RECORD_SIZE);
+}
+
+
+static bool read_slot(uint32_t slot, flash_log_record_t *record) {
+    const uint8_t *raw_record = (const uint8_t*)get_slot_address(slot);
+    uint32_t crc;
+
+
+    crc = crc_sw_clac(&crc_16_modbus, raw_record, RECORD_CRC_OFFSET);
+    if ((raw_record[RECORD_CRC_OFFSET] != (uint8_t)crc) || (raw_record[RECORD_CRC_OFFSET + 1] != (uint8_t)(crc >> 8))) return false;
+
+    record->seq = (uint32_t)raw_record[RECORD_SEQ_OFFSET] |
+                  ((uint32_t)raw_record[RECORD_SEQ_OFFSET + 1] << 8) |
+                  ((uint32_t)raw_record[RECORD_SEQ_OFFSET + 2] << 16) |
+                  ((uint32_t)raw_record[RECORD_SEQ_OFFSET + 3] << 24);
+    record->type = raw_record[RECORD_TYPE_OFFSET];
+    memcpy(record->data, &raw_record[RECORD_DATA_OFFSET], FLASH_LOG_RECORD_DATA_SIZE);
+    return true;
+}
+
+
+static bool is_slot_erased(uint32_t slot) {
+    const uint8_t *raw_record = (const uint8_t*)get_slot_address(slot);
+    uint32_t i;
+
+
+    for (i = 0; i < FLASH_LOG_RECORD_SIZE; i++) {
+        if (raw_record[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+
+static bool is_page_erased(uint32_t slot) {
+    const uint8_t *raw_page = (const uint8_t*)get_slot_address(slot - (slot % FLASH_LOG_RECORDS_PER_PAGE));
+    uint32_t i;
+
+
+    for (i = 0; i < INT_FLASH_PAGE_SIZE; i++) {
+        if (raw_page[i] != 0xFF) return false;
+    }
+    return true;
+}
@@ -0,0 +1,41 @@
+//  ***************************************************************************
+/// @file    flash_log.h
+/// @brief   Append-only records log in FLASH
+//  ***************************************************************************
+#ifndef _FLASH_LOG_H_
+#define _FLASH_LOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hal/int_flash_driver.h"
+#include "common/crc_calc.h"
+#include "flash.h"
+
+
+#define FLASH_LOG_RECORD_SIZE         (24)
+#define FLASH_LOG_RECORD_DATA_SIZE    (16)
+#define FLASH_LOG_RECORDS_PER_PAGE    (INT_FLASH_PAGE_SIZE / FLASH_LOG_RECORD_SIZE)
+#define FLASH_LOG_RECORDS_QTY         (FLASH_LOG_RECORDS_PER_PAGE * FLASH_LOG_PAGES_QTY)
+
+// Records types
+#define FLASH_LOG_TYPE_RUN            (1)
+#define FLASH_LOG_TYPE_EVENT          (2)
+
+
+typedef struct {
+    uint32_t seq;
+    uint8_t  type;
+    uint8_t  data[FLASH_LOG_RECORD_DATA_SIZE];
+} flash_log_record_t;
+
+
+extern void flash_log_init(void);
+
+extern bool flash_log_append(uint8_t type, const uint8_t *data);
+extern uint32_t flash_log_get_records_qty(void);
+extern bool flash_log_read(uint32_t record_n, flash_log_record_t *record);
+
+
+#endif   // _FLASH_LOG_H_
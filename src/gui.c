@@ -9,7 +9,7 @@
 #define DISPLAY_STANDBY_TIMEOUT_MS (60 * 1000)
 
 static i2c_t i2c = {
-    .peripheral = TIM17,
+    .peripheral = NULL,
     .speed_hz  = 1000000,
     .scl_pin   = PA1,
     .sda_pin   = PA0
@@ -39,6 +39,7 @@ void gui_init(void) {
 
 void gui_process(void) {
     ssd1306_process();
+    watchdog_check_in(WATCHDOG_TASK_GUI);
     if (timer_triggered(standby_timer) && !gui_is_standby) {
         ssd1306_standby(true);
         gui_is_standby = true;
@@ -67,6 +68,7 @@ void gui_print_center_msg(const uint8_t *msg) {
 
 
 void gui_print_profiles_menu_screen(uint8_t selected_item) {
+    uint8_t name[RG_PROFILE_NAME_SIZE + 1];
     uint32_t i, y;
   
   
@@ -75,11 +77,11 @@ void gui_print_profiles_menu_screen(uint8_t selected_item) {
     if (selected_item >= active_profiles_qty) selected_item = 0;
 
 
-    if (selected_item > 0) ssd1306_print_str(profiles[selected_item - 1].name, RG_PROFILE_NAME_SIZE, SSD1306_FOUNT_MODE_K1, 12, 0);
+    if ((selected_item > 0) && profiles_get_name((selected_item - 1), name)) ssd1306_print_str(name, RG_PROFILE_NAME_SIZE, SSD1306_FOUNT_MODE_K1, 12, 0);
     else ssd1306_print_str("", RG_PROFILE_NAME_SIZE, SSD1306_FOUNT_MODE_K1, 12, 0);
     for (i = 0; i < 3; i++) {
         y = selected_item + i;
-        if (y < active_profiles_qty) ssd1306_print_str(profiles[y].name, RG_PROFILE_NAME_SIZE, SSD1306_FOUNT_MODE_K1, 12, (8 * (i + 1)));
+        if (profiles_get_name(y, name)) ssd1306_print_str(name, RG_PROFILE_NAME_SIZE, SSD1306_FOUNT_MODE_K1, 12, (8 * (i + 1)));
         else ssd1306_print_str("", RG_PROFILE_NAME_SIZE, SSD1306_FOUNT_MODE_K1, 12, (8 * (i + 1)));
     }
     ssd1306_print_simw('>', SSD1306_FOUNT_MODE_K1, 0, 8);
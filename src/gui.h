@@ -16,6 +16,7 @@
 #include "dev/ssd1306.h"
 #include "registers.h"
 #include "profiles.h"
+#include "watchdog.h"
 
 
 extern bool gui_is_standby;
@@ -0,0 +1,143 @@
+//  ***************************************************************************
+/// @file    heater_supervisor.c
+/// @note    Checks every fresh heater temperature sample independently from
+///          heater control and process logic. Any fault is latched in
+///          fail_code and switches heater and fun off at once.
+//  ***************************************************************************
+#include "heater_supervisor.h"
+#include "outputs_driver.h"
+#include "error_handling.h"
+
+
+static bool is_first_sample;
+static uint16_t rate_ref_c_x10;
+static uint32_t rate_ref_time_ms;
+static uint16_t efficacy_ref_c_x10;
+static uint32_t efficacy_ref_on_time_ms;
+static uint16_t off_min_c_x10;
+static bool is_off_min_valid;
+
+
+static void check_sensor(uint16_t temperature_c_x10);
+static void check_efficacy(uint16_t temperature_c_x10);
+static void check_runaway(uint16_t temperature_c_x10);
+static void fault_shutdown(void);
+
+
+
+
+void heater_supervisor_init(void) {
+    is_first_sample = true;
+    is_off_min_valid = false;
+}
+
+
+//  ***************************************************************************
+/// @brief  Check heater temperature sample
+/// @param  temperature_c_x10 - fresh sample
+/// @return none
+//  ***************************************************************************
+void heater_supervisor_check(uint16_t temperature_c_x10) {
+    if (is_first_sample) {
+        rate_ref_c_x10 = temperature_c_x10;
+        rate_ref_time_ms = get_time_ms();
+        efficacy_ref_c_x10 = temperature_c_x10;
+        efficacy_ref_on_time_ms = heater_get_on_time_ms();
+        is_first_sample = false;
+    }
+
+    check_sensor(temperature_c_x10);
+    if (temperature_c_x10 > (HEATER_SUPERVISOR_OVERTEMP_C * 10)) eh_set_fail_heater_overtemperature(temperature_c_x10);
+    check_efficacy(temperature_c_x10);
+    check_runaway(temperature_c_x10);
+
+    if (fail_code & (FAIL_CODE_HEATER_SENSOR_ERROR | FAIL_CODE_HEATER_OVERTEMPERATURE |
+                     FAIL_CODE_HEATER_NOT_HEATING | FAIL_CODE_HEATER_RUNAWAY)) {
+        fault_shutdown();
+    }
+}
+
+
+
+
+//  ***************************************************************************
+/// @brief  Sensor plausibility: range and rate of change
+/// @param  temperature_c_x10
+/// @return none
+//  ***************************************************************************
+static void check_sensor(uint16_t temperature_c_x10) {
+    uint16_t delta_c_x10;
+
+
+    if ((temperature_c_x10 < HEATER_SUPERVISOR_SENSOR_MIN_C_X10) ||
+        (temperature_c_x10 > HEATER_SUPERVISOR_SENSOR_MAX_C_X10)) {
+        eh_set_fail_heater_sensor_error(temperature_c_x10);
+        return;
+    }
+
+    delta_c_x10 = (temperature_c_x10 > rate_ref_c_x10) ? (temperature_c_x10 - rate_ref_c_x10) : (rate_ref_c_x10 - temperature_c_x10);
+    if (delta_c_x10 > HEATER_SUPERVISOR_RATE_MAX_C_X10) {
+        eh_set_fail_heater_sensor_error(temperature_c_x10);
+        return;
+    }
+    if ((get_time_ms() - rate_ref_time_ms) >= HEATER_SUPERVISOR_RATE_WINDOW_MS) {
+        rate_ref_c_x10 = temperature_c_x10;
+        rate_ref_time_ms = get_time_ms();
+    }
+}
+
+
+//  ***************************************************************************
+/// @brief  Heating efficacy: heater disconnected or sensor off the plate
+/// @param  temperature_c_x10
+/// @return none
+/// @note   Checked only far below target, where heater works at full duty
+//  ***************************************************************************
+static void check_efficacy(uint16_t temperature_c_x10) {
+    uint32_t on_time_ms;
+
+
+    on_time_ms = heater_get_on_time_ms();
+    if ((heater_target_temperature_c == 0) ||
+        ((temperature_c_x10 / 10) + HEATER_SUPERVISOR_EFFICACY_BAND_C >= heater_target_temperature_c)) {
+        efficacy_ref_c_x10 = temperature_c_x10;
+        efficacy_ref_on_time_ms = on_time_ms;
+        return;
+    }
+
+    if ((on_time_ms - efficacy_ref_on_time_ms) < HEATER_SUPERVISOR_EFFICACY_ON_TIME_MS) return;
+
+    if (temperature_c_x10 < (efficacy_ref_c_x10 + HEATER_SUPERVISOR_EFFICACY_MIN_RISE_C_X10)) {
+        eh_set_fail_heater_not_heating(temperature_c_x10);
+    }
+    efficacy_ref_c_x10 = temperature_c_x10;
+    efficacy_ref_on_time_ms = on_time_ms;
+}
+
+
+//  ***************************************************************************
+/// @brief  Thermal runaway: temperature rises while heater pin is OFF
+/// @param  temperature_c_x10
+/// @return none
+/// @note   Margin covers natural overshoot after heater switched off
+//  ***************************************************************************
+static void check_runaway(uint16_t temperature_c_x10) {
+    if (is_heater_pin_en) {
+        is_off_min_valid = false;
+        return;
+    }
+
+    if (!is_off_min_valid || (temperature_c_x10 < off_min_c_x10)) {
+        off_min_c_x10 = temperature_c_x10;
+        is_off_min_valid = true;
+    }
+    if (temperature_c_x10 > (off_min_c_x10 + HEATER_SUPERVISOR_RUNAWAY_RISE_C_X10)) {
+        eh_set_fail_heater_runaway(temperature_c_x10);
+    }
+}
+
+
+static void fault_shutdown(void) {
+    heater_dis();
+    fun_dis();
+}
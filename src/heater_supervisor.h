@@ -0,0 +1,32 @@
+//  ***************************************************************************
+/// @file    heater_supervisor.h
+/// @brief   Heater sensor plausibility, heating efficacy and overtemperature checks
+//  ***************************************************************************
+#ifndef _HEATER_SUPERVISOR_H_
+#define _HEATER_SUPERVISOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+// Sensor range (sensor output is 10 mV/C): open or shorted sensor is out of it
+#define HEATER_SUPERVISOR_SENSOR_MIN_C_X10        (20)
+#define HEATER_SUPERVISOR_SENSOR_MAX_C_X10        (3000)
+// Max temperature change within HEATER_SUPERVISOR_RATE_WINDOW_MS
+#define HEATER_SUPERVISOR_RATE_MAX_C_X10          (200)
+#define HEATER_SUPERVISOR_RATE_WINDOW_MS          (1000)
+// Hard limit, regardless of target temperature
+#define HEATER_SUPERVISOR_OVERTEMP_C              (HEATER_MAX_TEMP_C + 15)
+// Heating efficacy: min rise per heater ON time while far below target
+#define HEATER_SUPERVISOR_EFFICACY_ON_TIME_MS     (30 * 1000)
+#define HEATER_SUPERVISOR_EFFICACY_MIN_RISE_C_X10 (30)
+#define HEATER_SUPERVISOR_EFFICACY_BAND_C         (10)
+// Runaway: rise while heater pin is OFF (shorted switch)
+#define HEATER_SUPERVISOR_RUNAWAY_RISE_C_X10      (150)
+
+
+extern void heater_supervisor_init(void);
+extern void heater_supervisor_check(uint16_t temperature_c_x10);
+
+
+#endif  // _HEATER_SUPERVISOR_H_
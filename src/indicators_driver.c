@@ -5,63 +5,119 @@
 
 
 #define LEDS_PIN   (PA4)
-#define BUZZER_PIN (PB1)
+#define BUZZER_PIN (PB1)            // TIM3_CH4, AF1
+
+#define BUZZER_TIM                  (TIM3)
+#define BUZZER_TIM_AF               (1)
+#define BUZZER_TIM_TICK_HZ          (1'000'000)
+#define BUZZER_REST_PERIOD_TICKS    (BUZZER_TIM_TICK_HZ / 1000)     // 1 ms
+
+#define BUZZER_OC_MODE_FORCE_INACTIVE   (4)
+#define BUZZER_OC_MODE_PWM_1            (6)
 
 static bool is_led_process, is_led_error_en;
 
 
-typedef enum {
-    BUZZER_STATE_IDLE,
-    BUZZER_STATE_BEEP_PROC,
-} buzzer_process_state_t;
+typedef struct {
+    uint16_t freq_hz;               // 0 - rest
+    uint16_t duration_ms;
+} buzzer_note_t;
 
 typedef struct {
     uint8_t  repeats_qty;
-    uint8_t  durations_qty;
-    const uint16_t *durations_ms;
+    uint8_t  notes_qty;
+    const buzzer_note_t *notes;
 } buzzer_melody_t;
 
-static buzzer_process_state_t buzzer_process_state;
-static timer_t buzzer_timer;
-static uint8_t buzzer_duration_counter;
-static uint8_t buzzer_repeat_counter;
-static uint8_t buzzer_task;
-static bool buzzer_state;
+// Sequencer state, changed by TIM3 interrupt
+static const buzzer_melody_t *volatile buzzer_melody;
+static volatile uint8_t buzzer_note_index;
+static volatile uint8_t buzzer_repeat_counter;
+static volatile uint32_t buzzer_periods_left;
 
-static const uint16_t beep_melody_durations[] = {300};
-static const uint16_t process_done_melody_durations[] = {800, 800};
-static const uint16_t error_melody_durations[] = {200, 100, 200, 100, 200, 1000};
+static const buzzer_note_t beep_melody_notes[] = {
+    {2700, 300}
+};
+// Rising three tones
+static const buzzer_note_t process_done_melody_notes[] = {
+    {2000, 250}, {2700, 250}, {3400, 300}, {0, 800}
+};
+// High-low alarm
+static const buzzer_note_t error_melody_notes[] = {
+    {3400, 200}, {0, 100}, {2000, 200}, {0, 100}, {3400, 200}, {0, 1000}
+};
 
 static const buzzer_melody_t buzzer_melodyes[] = {
-    {1, (sizeof(beep_melody_durations) / sizeof(uint16_t)), beep_melody_durations},
-    {5, (sizeof(process_done_melody_durations) / sizeof(uint16_t)), process_done_melody_durations},
-    {5, (sizeof(error_melody_durations) / sizeof(uint16_t)), error_melody_durations},
+    {1, (sizeof(beep_melody_notes) / sizeof(buzzer_note_t)), beep_melody_notes},
+    {5, (sizeof(process_done_melody_notes) / sizeof(buzzer_note_t)), process_done_melody_notes},
+    {5, (sizeof(error_melody_notes) / sizeof(buzzer_note_t)), error_melody_notes},
 };
 
 
 static void led_process(void);
-static void buzzer_process(void);
-static void buzzer_en(void);
-static void buzzer_dis(void);
+static void buzzer_start(const buzzer_melody_t *melody);
+static void buzzer_stop(void);
+static void buzzer_note_start(const buzzer_note_t *note);
+static void buzzer_set_oc_mode(uint32_t oc_mode);
+static void buzzer_set_tim_clock(void);
+static void clock_change_callback(uint32_t sysclk_hz);
 
 
 
 
 void indicators_init(void) {
     gpio_config_pins(LEDS_PIN, GPIO_MODE_OUTPUT_PP, GPIO_PULL_NONE, GPIO_SPEED_HIGH, 0, true);
-    gpio_config_pins(BUZZER_PIN, GPIO_MODE_OUTPUT_PP, GPIO_PULL_NONE, GPIO_SPEED_HIGH, 0, false);
+    gpio_config_pins(BUZZER_PIN, GPIO_MODE_ALT_FUNCTION_PP, GPIO_PULL_NONE, GPIO_SPEED_HIGH, BUZZER_TIM_AF, false);
 
     is_led_process = false;
     is_led_error_en = false;
 
-    buzzer_process_state = BUZZER_STATE_IDLE;
-    buzzer_task = 0xFF;
+    sysclk_enable_peripheral(BUZZER_TIM);
+    BUZZER_TIM->CR1 = 0;
+    BUZZER_TIM->CCMR2 = BUZZER_OC_MODE_FORCE_INACTIVE << TIM_CCMR2_OC4M_Pos;
+    BUZZER_TIM->CCER = TIM_CCER_CC4E;
+    buzzer_set_tim_clock();
+    BUZZER_TIM->EGR = TIM_EGR_UG;   // Load prescaler
+    BUZZER_TIM->SR = 0;
+    BUZZER_TIM->DIER = TIM_DIER_UIE;
+    buzzer_melody = NULL;
+
+    mcu_clock_add_change_callback(clock_change_callback);
 }
 
 
 void indicators_process(void) {
     led_process();
-    buzzer_process();
+}
+
+
+//  ***************************************************************************
+/// @brief  TIM3 interrupt: next period of note, next note or melody end
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void indicators_buzzer_handler(void) {
+    const buzzer_melody_t *melody = buzzer_melody;
+
+
+    BUZZER_TIM->SR = ~TIM_SR_UIF;   // Clear flag
+    if (melody == NULL) return;
+
+    if (buzzer_periods_left > 1) {
+        buzzer_periods_left--;
+        return;
+    }
+
+    buzzer_note_index++;
+    if (buzzer_note_index >= melody->notes_qty) {
+        buzzer_note_index = 0;
+        buzzer_repeat_counter++;
+        if (buzzer_repeat_counter >= melody->repeats_qty) {
+            buzzer_stop();
+            return;
+        }
+    }
+    buzzer_note_start(&melody->notes[buzzer_note_index]);
 }
 
 
@@ -75,80 +131,111 @@ void indicators_led_error(bool en_dis) {
 
 
 void indicators_buzzer_beep_terminate(void) {
-    buzzer_task = 0xFF;
-    buzzer_process_state = BUZZER_STATE_IDLE;
-    buzzer_state = false;
-    buzzer_dis();
+    BUZZER_TIM->DIER &= ~TIM_DIER_UIE;
+    buzzer_stop();
+    BUZZER_TIM->DIER |= TIM_DIER_UIE;
 }
 
 
 void indicators_buzzer_short_beep(void) {
-    buzzer_task = 0;
+    buzzer_start(&buzzer_melodyes[0]);
 }
 
 
 void indicators_buzzer_process_done_beep(void) {
-    buzzer_task = 1;
+    buzzer_start(&buzzer_melodyes[1]);
 }
 
 
 void indicators_buzzer_error_beep(void) {
-    buzzer_task = 2;
-}
-
-
-
-
-static void buzzer_process(void) {
-    switch (buzzer_process_state) {
-        case BUZZER_STATE_IDLE:
-            if (buzzer_task != 0xFF) {
-                buzzer_duration_counter = 0;
-                buzzer_repeat_counter = 0;
-                buzzer_timer = timer_start_ms(buzzer_melodyes[buzzer_task].durations_ms[0]);
-                buzzer_process_state = BUZZER_STATE_BEEP_PROC;
-                buzzer_state = true;
-                buzzer_en();
-            }
-            break;
-
-
-        case BUZZER_STATE_BEEP_PROC:
-            if (timer_triggered(buzzer_timer)) {
-                buzzer_duration_counter++;
-                if (buzzer_duration_counter >= buzzer_melodyes[buzzer_task].durations_qty) {
-                    buzzer_duration_counter = 0;
-                    buzzer_repeat_counter++;
-                    if (buzzer_repeat_counter >= buzzer_melodyes[buzzer_task].repeats_qty) {
-                        buzzer_process_state = BUZZER_STATE_IDLE;
-                        buzzer_task = 0xFF;
-                        buzzer_dis();
-                        return;
-                    }
-                }
-
-                buzzer_timer = timer_start_ms(buzzer_melodyes[buzzer_task].durations_ms[buzzer_duration_counter]);
-                if (buzzer_state) {
-                    buzzer_state = false;
-                    buzzer_dis();
-                }
-                else {
-                    buzzer_state = true;
-                    buzzer_en();
-                }
-            }
-            break;
+    buzzer_start(&buzzer_melodyes[2]);
+}
+
+
+
+
+//  ***************************************************************************
+/// @brief  Start melody from the first note, playing melody is replaced
+/// @param  melody - melody
+/// @return none
+//  ***************************************************************************
+static void buzzer_start(const buzzer_melody_t *melody) {
+    BUZZER_TIM->DIER &= ~TIM_DIER_UIE;
+    BUZZER_TIM->CR1 &= ~TIM_CR1_CEN;
+
+    buzzer_melody = melody;
+    buzzer_note_index = 0;
+    buzzer_repeat_counter = 0;
+    BUZZER_TIM->CNT = 0;
+    buzzer_note_start(&melody->notes[0]);
+
+    BUZZER_TIM->SR = ~TIM_SR_UIF;
+    BUZZER_TIM->DIER |= TIM_DIER_UIE;
+    BUZZER_TIM->CR1 |= TIM_CR1_CEN;
+}
+
+
+//  ***************************************************************************
+/// @brief  Stop timer with output low, called with update interrupt disabled
+/// @param  none
+/// @return none
+//  ***************************************************************************
+static void buzzer_stop(void) {
+    BUZZER_TIM->CR1 &= ~TIM_CR1_CEN;
+    buzzer_set_oc_mode(BUZZER_OC_MODE_FORCE_INACTIVE);
+    buzzer_melody = NULL;
+}
+
+
+//  ***************************************************************************
+/// @brief  Set note period, duty cycle and duration
+/// @param  note - note
+/// @return none
+/// @note   Called at period start (update event), so registers are written
+///         without preload. Rest is counted by 1 ms periods.
+//  ***************************************************************************
+static void buzzer_note_start(const buzzer_note_t *note) {
+    uint32_t period_ticks;
+
+
+    if (note->freq_hz == 0) {
+        buzzer_set_oc_mode(BUZZER_OC_MODE_FORCE_INACTIVE);
+        BUZZER_TIM->ARR = BUZZER_REST_PERIOD_TICKS - 1;
+        buzzer_periods_left = note->duration_ms;
+    }
+    else {
+        period_ticks = BUZZER_TIM_TICK_HZ / note->freq_hz;
+        BUZZER_TIM->ARR = period_ticks - 1;
+        BUZZER_TIM->CCR4 = period_ticks / 2;
+        buzzer_set_oc_mode(BUZZER_OC_MODE_PWM_1);
+        buzzer_periods_left = ((uint32_t)note->freq_hz * note->duration_ms) / 1000;
     }
+    if (buzzer_periods_left == 0) buzzer_periods_left = 1;
 }
 
 
-static void buzzer_en(void) {
-    gpio_set_pins(BUZZER_PIN);
+static void buzzer_set_oc_mode(uint32_t oc_mode) {
+    BUZZER_TIM->CCMR2 = (BUZZER_TIM->CCMR2 & ~TIM_CCMR2_OC4M_Msk) | (oc_mode << TIM_CCMR2_OC4M_Pos);
+}
+
+
+//  ***************************************************************************
+/// @brief  Set timer prescaler for BUZZER_TIM_TICK_HZ
+/// @param  none
+/// @return none
+/// @note   Prescaler is preloaded, new value works from the next period
+//  ***************************************************************************
+static void buzzer_set_tim_clock(void) {
+    uint32_t tim_clock_hz;
+
+
+    sysclk_get_peripheral_freq(BUZZER_TIM, &tim_clock_hz);
+    BUZZER_TIM->PSC = (tim_clock_hz / BUZZER_TIM_TICK_HZ) - 1;
 }
 
 
-static void buzzer_dis(void) {
-    gpio_reset_pins(BUZZER_PIN);
+static void clock_change_callback(uint32_t sysclk_hz) {
+    buzzer_set_tim_clock();
 }
 
 
@@ -11,10 +11,12 @@
 #include "hal/gpio.h"
 #include "hal/sysclk.h"
 #include "hal/systimer.h"
+#include "mcu_clock.h"
 
 
 extern void indicators_init(void);
 extern void indicators_process(void);
+extern void indicators_buzzer_handler(void);
 
 extern void indicators_led_process(bool en_dis);
 extern void indicators_led_error(bool en_dis);
@@ -3,23 +3,32 @@
 //  ***************************************************************************
 #include "irq_handlers.h"
 #include "hal/systimer.h"
+#include "hal/timebase.h"
 #include "mcu_clock.h"
 #include "hal/int_adc_driver.h"
 #include "usb_cdc.h"
+#include "crash_dump.h"
+#include "button_driver.h"
 #include "indicators_driver.h"
 
 
 void irq_handlers_init(void) {
     NVIC_SetPriority(SysTick_IRQn, 1);
+    NVIC_SetPriority(TIMEBASE_IRQN, 1);
     NVIC_SetPriority(RCC_IRQn, 1);
     NVIC_SetPriority(USB_IRQn, 2);
+    NVIC_SetPriority(EXTI4_15_IRQn, 2);
     NVIC_SetPriority(ADC1_IRQn, 3);
+    NVIC_SetPriority(TIM3_IRQn, 3);
 
 
     NVIC_EnableIRQ(SysTick_IRQn);
+    NVIC_EnableIRQ(TIMEBASE_IRQN);
     NVIC_EnableIRQ(ADC1_IRQn);
+    NVIC_EnableIRQ(TIM3_IRQn);
     NVIC_EnableIRQ(RCC_IRQn);
     NVIC_EnableIRQ(USB_IRQn);
+    NVIC_EnableIRQ(EXTI4_15_IRQn);
 }
 
 
@@ -28,14 +37,10 @@ void NMI_Handler(void) {
 
 }
 
-void HardFault_Handler(void);
-void HardFault_Handler(void) {
-    mcu_clock_set_safe_config();
-    indicators_init();
-    indicators_led_error(true);
-    while (1) {
-        indicators_process();
-    }
+// Stackless: MSP points to exception stack frame (PSP isn't used)
+__stackless void HardFault_Handler(void);
+__stackless void HardFault_Handler(void) {
+    crash_dump_hard_fault((const uint32_t*)__get_MSP());
 }
 
 void SVC_Handler(void);
@@ -53,6 +58,16 @@ void SysTick_Handler(void) {
     systimer_handler();
 }
 
+void TIM14_IRQHandler(void);
+void TIM14_IRQHandler(void) {
+    timebase_handler();
+}
+
+void TIM3_IRQHandler(void);
+void TIM3_IRQHandler(void) {
+    indicators_buzzer_handler();
+}
+
 void ADC1_IRQHandler(void);
 void ADC1_IRQHandler(void) {
     int_adc_handler();
@@ -63,6 +78,11 @@ void RCC_IRQHandler(void) {
     mcu_clock_hse_error_handler();
 }
 
+void EXTI4_15_IRQHandler(void);
+void EXTI4_15_IRQHandler(void) {
+    button_exti_handler();
+}
+
 void USB_IRQHandler(void);
 void USB_IRQHandler(void) {
     usb_cdc_handler();
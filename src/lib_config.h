@@ -10,14 +10,21 @@
 // #define ERRORS_STRINGS
 
 #define CLI_CMD_MAX_ARG_QTY   (10)
-#define CLI_TX_BUFF_SIZE      (100)
+#define CLI_TX_BUFF_SIZE      (256)
 #define CLI_RX_BUFF_SIZE      (100)
 #define CLI_RX_RAW_BUFF_SIZE  (100)
 #define CLI_PRINTF_BUFF_SIZE  (100)
+#define CLI_HISTORY_BUFF_SIZE (128)
 #define CLI_PROMPT            ("> ")
 
 #define INT_ADC_MAX_CHANNELS_QTY    (3)
 
+#define TIMER_WHEEL_SLOTS_QTY       (8)    // power of 2
+
+#define TIMEBASE_TIM                (TIM14)
+#define TIMEBASE_IRQN               (TIM14_IRQn)
+#define TIMEBASE_TICKS_PER_US       (8)    // power of 2, 125 ns tick
+
 // #define SSD1306_USE_SMALL_REGISTER
 #define SSD1306_W             (128)
 #define SSD1306_H             (32)
@@ -5,6 +5,7 @@
 #include "hal/gpio.h"
 #include "hal/sysclk.h"
 #include "hal/systimer.h"
+#include "hal/timer_wheel.h"
 #include "irq_handlers.h"
 #include "mcu_clock.h"
 #include "profiles.h"
@@ -14,6 +15,10 @@
 #include "error_handling.h"
 #include "registers.h"
 #include "flash.h"
+#include "flash_log.h"
+#include "watchdog.h"
+#include "event_journal.h"
+#include "crash_dump.h"
 
 
 /*
@@ -29,24 +34,35 @@ uint8_t selected_item = 0;
 int main (void) {
     irq_handlers_init();
 
+    flash_log_init();
+    event_journal_init();
     error_handling_init();
+    watchdog_init();
+    crash_dump_init();
     
     mcu_clock_set_normal_config();
     sysclk_enable_peripheral(GPIOA);
     sysclk_enable_peripheral(GPIOB);
+    timer_wheel_init();
     
     flash_init();
     regs_init();
     profiles_init();
     cli_cmd_init();
     system_operation_init();
-    cli_safe_printf("\r\n/E/ Hi! /\r\n\r\n> ");
+    cli_print("\r\n/E/ Hi! /\r\n\r\n> ");
 
     delay_ms(1000);
+    watchdog_start();
 
 
     while (1) {
+        timer_wheel_process();
+        watchdog_process();
+        event_journal_process();
         regs_process();
+        flash_process();
+        profiles_process();
         cli_cmd_process();
         system_operation_process();
     }
@@ -9,6 +9,7 @@
 #include "common/error.h"
 #include "hal/sysclk.h"
 #include "hal/systimer.h"
+#include "hal/timebase.h"
 #include "error_handling.h"
 
 
@@ -19,6 +20,14 @@ static const sysclk_extcfg_t sysclk_extcfg = {
     .hse_freq_hz      = 16'000'000,
 };
 
+static mcu_clock_profile_t current_profile = MCU_CLOCK_PROFILE_LOW_POWER;
+static bool is_normal_config_failed = false;
+static mcu_clock_change_callback change_callbacks[MCU_CLOCK_CALLBACKS_QTY];
+static uint32_t change_callbacks_qty = 0;
+
+
+static void notify_clock_change(void);
+
 
 
 
@@ -108,6 +117,7 @@ error_t mcu_clock_set_normal_config(void) {
         if (timer_triggered(timeout)) {
             // PLL doesn't work
             eh_set_fail_fw_error(E_FAILED);
+            is_normal_config_failed = true;
             mcu_clock_set_safe_config();
             return E_FAILED;
         }
@@ -124,6 +134,7 @@ error_t mcu_clock_set_normal_config(void) {
     RCC->CFGR = rcc_cfgr_new_value;
 
     systimer_init();
+    timebase_init();
     SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;    // Enable SysTick
     // Wait for SW switch to PLL
     timeout = timer_start_ms(SYSCLK_SOURCE_NOTREADY_TIMEOUT_MS);
@@ -131,6 +142,7 @@ error_t mcu_clock_set_normal_config(void) {
         if (timer_triggered(timeout)) {
             // SW doesn't switch
             eh_set_fail_fw_error(E_FAILED);
+            is_normal_config_failed = true;
             mcu_clock_set_safe_config();
             return E_FAILED;
         }
@@ -145,7 +157,8 @@ error_t mcu_clock_set_normal_config(void) {
                   (UART1_SRC_APB << RCC_CFGR3_USART1SW_Pos) |
                   (USB_SRC_PLLCLK << RCC_CFGR3_USBSW_Pos);
 
-
+    current_profile = MCU_CLOCK_PROFILE_NORMAL;
+    notify_clock_change();
     return E_OK;
 }
 
@@ -183,6 +196,7 @@ void mcu_clock_set_safe_config() {
     while (((RCC->CFGR & RCC_CFGR_SWS) >> RCC_CFGR_SWS_Pos) != RCC_CFGR_SW_HSI);
 
     systimer_init();
+    timebase_init();
     SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;    // Enable SysTick
 
     // Set proper flash latency
@@ -194,8 +208,67 @@ void mcu_clock_set_safe_config() {
                   (UART1_SRC_APB << RCC_CFGR3_USART1SW_Pos) | 
                   (USB_SRC_NONE << RCC_CFGR3_USBSW_Pos);;
 
+    // Clock security system disable (before HSE)
+    RCC->CR &= ~RCC_CR_CSSON;
     // Disable HSE and PLLs
     RCC->CR &= ~(RCC_CR_PLLON_Msk | RCC_CR_HSEON_Msk);
-    // Clock security system disable
-    RCC->CR &= RCC_CR_CSSON;
+
+    current_profile = MCU_CLOCK_PROFILE_LOW_POWER;
+    notify_clock_change();
+}
+
+
+//  ***************************************************************************
+/// @brief      Switch MCU clock profile
+/// @param      profile - @ref mcu_clock_profile_t
+/// @return     error_t
+/// @note       Does nothing if profile is already set. Normal profile isn't
+///             retried after PLL failure (each try blocks for timeouts).
+//  ***************************************************************************
+error_t mcu_clock_set_profile(mcu_clock_profile_t profile) {
+    if (profile == current_profile) return E_OK;
+
+    if (profile == MCU_CLOCK_PROFILE_NORMAL) {
+        if (is_normal_config_failed) return E_FAILED;
+        return mcu_clock_set_normal_config();
+    }
+    mcu_clock_set_safe_config();
+    return E_OK;
+}
+
+
+//  ***************************************************************************
+/// @brief      Get current MCU clock profile
+/// @param      none
+/// @return     @ref mcu_clock_profile_t
+//  ***************************************************************************
+mcu_clock_profile_t mcu_clock_get_profile(void) {
+    return current_profile;
+}
+
+
+//  ***************************************************************************
+/// @brief      Add clock change callback
+/// @param      callback - called after every SYSCLK change, may be called
+///             from RCC interrupt (HSE failure)
+/// @return     true - success, false - no free slots
+//  ***************************************************************************
+bool mcu_clock_add_change_callback(mcu_clock_change_callback callback) {
+    if (change_callbacks_qty >= MCU_CLOCK_CALLBACKS_QTY) return false;
+    change_callbacks[change_callbacks_qty] = callback;
+    change_callbacks_qty++;
+    return true;
+}
+
+
+
+
+static void notify_clock_change(void) {
+    uint32_t sysclk_hz, i;
+
+
+    sysclk_get_bus_freq(SYSCLK_CORE, &sysclk_hz);
+    for (i = 0; i < change_callbacks_qty; i++) {
+        change_callbacks[i](sysclk_hz);
+    }
 }
@@ -5,14 +5,32 @@
 #ifndef _MCU_CLOCK_H_
 #define _MCU_CLOCK_H_
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "common/error.h"
 
 
+#define MCU_CLOCK_CALLBACKS_QTY      (4)
+
+
+typedef enum {
+    MCU_CLOCK_PROFILE_NORMAL = 0,    // PLL 48 MHz, USB
+    MCU_CLOCK_PROFILE_LOW_POWER      // HSI 8 MHz, no USB (same as safe configuration)
+} mcu_clock_profile_t;
+
+// Called after every SYSCLK change, systimer and timebase are already reconfigured
+typedef void (*mcu_clock_change_callback)(uint32_t sysclk_hz);
+
+
 extern void mcu_clock_hse_error_handler(void);
 
 extern error_t mcu_clock_set_normal_config(void);
 extern void mcu_clock_set_safe_config(void);
 
+extern error_t mcu_clock_set_profile(mcu_clock_profile_t profile);
+extern mcu_clock_profile_t mcu_clock_get_profile(void);
+extern bool mcu_clock_add_change_callback(mcu_clock_change_callback callback);
+
 
 
 #endif  // _MCU_CLOCK_H_
@@ -11,23 +11,20 @@
 
 #define MCU_TEMPERATURE_MAX_C           (85 + 10)
 
+// ADC clock <= 14 MHz: PCLK / 4 at 48 MHz, PCLK / 2 at 8 MHz
+#define ADC_PCLK_DIV_4_MIN_FREQ_HZ      (24'000'000)
 
-#define FUN_ON gpio_set_pins(FUN_PIN)
-#define FUN_OFF gpio_reset_pins(FUN_PIN)
 
-typedef enum {
-    FUN_STATE_IDLE = 0,
-    FUN_STATE_EN_ACTIVE,
-    FUN_STATE_EN_INACTIVE
-} fun_state_t;
+#define FUN_ON gpio_set_pins(FUN_PIN); is_fun_pin_en = true;
+#define FUN_OFF gpio_reset_pins(FUN_PIN); is_fun_pin_en = false;
 
-static fun_state_t fun_state;
-static timer_t fun_timer;
+static timer_wheel_timer_t fun_timer;
 static uint32_t fun_en_time_ms, fun_dis_time_ms;
+bool is_fun_pin_en;
 
 
-#define HEATER_ON gpio_set_pins(HEATER_PIN); is_heater_pin_en = true;
-#define HEATER_OFF gpio_reset_pins(HEATER_PIN); is_heater_pin_en = false;
+#define HEATER_ON heater_pin_on();
+#define HEATER_OFF heater_pin_off();
 
 uint32_t heater_active_time_ms = 1 * 1000;
 uint32_t heater_delay_time_ms = 10 * 1000;
@@ -44,9 +41,13 @@ typedef enum {
 static heater_state_t heater_state;
 static timer_t heater_timer;
 uint8_t heater_current_temperature_c;
+uint16_t heater_current_temperature_c_x10;
+uint16_t heater_temperature_sensor_adc_raw;
 bool is_heater_pin_en;
+static uint32_t heater_on_time_acc_ms;
+static uint32_t heater_on_timestamp_ms;
 static uint8_t mcu_current_temperature_c;
-static uint8_t heater_target_temperature_c;
+uint8_t heater_target_temperature_c;
 
 static int_adc_channel_t int_adc_channel_mcu_temp_sensor = {
     .channel_number = INT_ADC_TEMPERATURE_CHANNEL,
@@ -62,6 +63,12 @@ static int_adc_channel_t int_adc_channel_vrefint = {
 };
 
 
+static void heater_pin_on(void);
+static void heater_pin_off(void);
+static void fun_timer_callback(void *arg);
+static void clock_change_callback(uint32_t sysclk_hz);
+
+
 void outputs_init(void) {
     gpio_config_pins(FUN_PIN, GPIO_MODE_OUTPUT_PP, GPIO_PULL_NONE, GPIO_SPEED_LOW, 0, false);
     gpio_config_pins(HEATER_PIN, GPIO_MODE_OUTPUT_PP, GPIO_PULL_NONE, GPIO_SPEED_LOW, 0, false);
@@ -72,10 +79,17 @@ void outputs_init(void) {
     int_adc_add_channel(&int_adc_channel_heater_temp_sensor);
     int_adc_add_channel(&int_adc_channel_vrefint);
     int_adc_start_continuous_converts();
+    mcu_clock_add_change_callback(clock_change_callback);
     heater_current_temperature_c = HEATER_MAX_TEMP_C;
+    heater_current_temperature_c_x10 = HEATER_MAX_TEMP_C * 10;
+    heater_temperature_sensor_adc_raw = 0;
+    heater_target_temperature_c = 0;
     is_heater_pin_en = false;
+    is_fun_pin_en = false;
+    heater_on_time_acc_ms = 0;
+    heater_supervisor_init();
+    vdda_monitor_init();
 
-    fun_state = FUN_STATE_IDLE;
     heater_state = HEATER_STATE_IDLE;
 }
 
@@ -88,18 +102,24 @@ void meas_process(void) {
     // Vdda
     if (int_adc_is_raw_data_ready(&int_adc_channel_vrefint, &adc_raw)) {
         adc_vdd_mv = int_adc_calc_vdda(adc_raw);
+        vdda_monitor_sample(adc_vdd_mv, is_heater_pin_en);
     }
 
     if (adc_vdd_mv > 0) {
-        // Heater temperature
-        if (int_adc_is_voltage_data_ready(&int_adc_channel_heater_temp_sensor, &adc_mv, adc_vdd_mv)) {
+        // Heater temperature (sensor output is 10 mV/C)
+        if (int_adc_is_raw_data_ready(&int_adc_channel_heater_temp_sensor, &adc_raw)) {
+            heater_temperature_sensor_adc_raw = adc_raw;
+            adc_mv = ((uint32_t)adc_raw * adc_vdd_mv) / 4095;
+            heater_current_temperature_c_x10 = adc_mv;
             heater_current_temperature_c = adc_mv / 10;
+            heater_supervisor_check(heater_current_temperature_c_x10);
+            watchdog_check_in(WATCHDOG_TASK_MEASUREMENT);
         }
 
         // MCU temperature
         if (int_adc_is_raw_data_ready(&int_adc_channel_mcu_temp_sensor, &adc_raw)) {
             mcu_current_temperature_c = int_adc_calc_tc(adc_raw, adc_vdd_mv);
-            if (mcu_current_temperature_c > MCU_TEMPERATURE_MAX_C) eh_set_fail_mcu_overtemperature();
+            if (mcu_current_temperature_c > MCU_TEMPERATURE_MAX_C) eh_set_fail_mcu_overtemperature(mcu_current_temperature_c);
         }
     }
 }
@@ -109,32 +129,6 @@ void outputs_process(void) {
     
     meas_process();
 
-    switch (fun_state) {
-        case FUN_STATE_IDLE:
-            break;
-
-        case FUN_STATE_EN_ACTIVE:
-            if (timer_triggered(fun_timer)) {
-                FUN_OFF;
-                fun_timer = timer_restart_ms(fun_timer, fun_dis_time_ms);
-                fun_state = FUN_STATE_EN_INACTIVE;
-            }
-            break;
-
-        case FUN_STATE_EN_INACTIVE:
-            if (timer_triggered(fun_timer)) {
-                FUN_ON;
-                fun_timer = timer_restart_ms(fun_timer, fun_en_time_ms);
-                fun_state = FUN_STATE_EN_ACTIVE;
-            }
-            break;
-        
-        default:
-            FUN_OFF;
-            fun_state = FUN_STATE_IDLE;
-            break;
-    }
-
 
     switch (heater_state) {
         case HEATER_STATE_IDLE:
@@ -181,11 +175,17 @@ void outputs_process(void) {
             heater_state = HEATER_STATE_IDLE;
             break;
     }
+
+    watchdog_check_in(WATCHDOG_TASK_CONTROL);
 }
 
 
 void heater_en(uint8_t target_temperature_c) {
-    if (target_temperature_c == 0) heater_dis();
+    // No heating with any failure: supervisor faults are latched
+    if ((target_temperature_c == 0) || (fail_code != 0)) {
+        heater_dis();
+        return;
+    }
     if (target_temperature_c > HEATER_MAX_TEMP_C) target_temperature_c = HEATER_MAX_TEMP_C;
 
     heater_target_temperature_c = target_temperature_c;
@@ -197,10 +197,24 @@ void heater_en(uint8_t target_temperature_c) {
 
 void heater_dis(void) {
     HEATER_OFF;
+    heater_target_temperature_c = 0;
     heater_state = HEATER_STATE_IDLE;
 }
 
 
+//  ***************************************************************************
+/// @brief  Get heater total ON time
+/// @param  none
+/// @return heater pin ON time since power-up [ms], wraps around
+/// @note   Heater duty cycle over some period is the delta of two calls
+///         divided by the period.
+//  ***************************************************************************
+uint32_t heater_get_on_time_ms(void) {
+    if (!is_heater_pin_en) return heater_on_time_acc_ms;
+    return heater_on_time_acc_ms + (get_time_ms() - heater_on_timestamp_ms);
+}
+
+
 void fun_en(uint32_t period_s, uint8_t duty_cycle_pct) {
     if (duty_cycle_pct > 100) duty_cycle_pct = 100;
 
@@ -211,8 +225,7 @@ void fun_en(uint32_t period_s, uint8_t duty_cycle_pct) {
         fun_dis_time_ms -= fun_en_time_ms;
 
         FUN_ON;
-        fun_timer = timer_start_ms(fun_en_time_ms);
-        fun_state = FUN_STATE_EN_ACTIVE;
+        timer_wheel_start(&fun_timer, fun_en_time_ms, 0, fun_timer_callback, NULL);
     }
     else {
         fun_dis();
@@ -221,6 +234,54 @@ void fun_en(uint32_t period_s, uint8_t duty_cycle_pct) {
 
 
 void fun_dis(void) {
+    timer_wheel_stop(&fun_timer);
     FUN_OFF;
-    fun_state = FUN_STATE_IDLE;
+}
+
+
+
+
+static void heater_pin_on(void) {
+    gpio_set_pins(HEATER_PIN);
+    if (!is_heater_pin_en) heater_on_timestamp_ms = get_time_ms();
+    is_heater_pin_en = true;
+}
+
+
+static void heater_pin_off(void) {
+    gpio_reset_pins(HEATER_PIN);
+    if (is_heater_pin_en) heater_on_time_acc_ms += get_time_ms() - heater_on_timestamp_ms;
+    is_heater_pin_en = false;
+}
+
+
+//  ***************************************************************************
+/// @brief  Fun PWM phase end: toggle pin and start the next phase
+/// @param  arg - not used
+/// @return none
+//  ***************************************************************************
+static void fun_timer_callback(void *arg) {
+    if (is_fun_pin_en && (fun_dis_time_ms > 0)) {
+        FUN_OFF;
+        timer_wheel_restart(&fun_timer, fun_dis_time_ms);
+    }
+    else {
+        FUN_ON;
+        timer_wheel_restart(&fun_timer, fun_en_time_ms);
+    }
+}
+
+
+//  ***************************************************************************
+/// @brief  Keep ADC clock in range after SYSCLK change
+/// @param  sysclk_hz - new SYSCLK frequency
+/// @return none
+//  ***************************************************************************
+static void clock_change_callback(uint32_t sysclk_hz) {
+    if (sysclk_hz >= ADC_PCLK_DIV_4_MIN_FREQ_HZ) {
+        int_adc_set_clk_src(INT_ADC_CLK_SRC_PCLK_DIV_4);
+    }
+    else {
+        int_adc_set_clk_src(INT_ADC_CLK_SRC_PCLK_DIV_2);
+    }
 }
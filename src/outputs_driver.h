@@ -10,15 +10,24 @@
 #include <stdlib.h>
 #include "hal/gpio.h"
 #include "hal/systimer.h"
+#include "hal/timer_wheel.h"
 #include "hal/int_adc_driver.h"
 #include "error_handling.h"
+#include "mcu_clock.h"
+#include "watchdog.h"
+#include "heater_supervisor.h"
+#include "vdda_monitor.h"
 
 
 #define HEATER_MAX_TEMP_C              (200)
 
 
 extern uint8_t heater_current_temperature_c;
+extern uint16_t heater_current_temperature_c_x10;
+extern uint16_t heater_temperature_sensor_adc_raw;
+extern uint8_t heater_target_temperature_c;
 extern bool is_heater_pin_en;
+extern bool is_fun_pin_en;
 
 extern uint32_t heater_active_time_ms;
 extern uint32_t heater_delay_time_ms;
@@ -31,6 +40,7 @@ extern void outputs_process(void);
 
 extern void heater_en(uint8_t target_temperature_c);
 extern void heater_dis(void);
+extern uint32_t heater_get_on_time_ms(void);
 extern void fun_en(uint32_t period_s, uint8_t duty_cycle_pct);
 extern void fun_dis(void);
 
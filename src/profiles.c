@@ -1,41 +1,271 @@
 //  ***************************************************************************
 /// @file    profiles.c
+/// @note    Profiles are stored in FLASH one after another in variable-length
+///          format (see RG_PROFILE_x in registers_map.h), the first broken or
+///          empty profile header ends the list. Only profiles offsets are kept
+///          in RAM: names are read from memory-mapped FLASH, stages are decoded
+///          on demand. Index is rebuilt after every FLASH commit.
+///          Every indexed profile is validated against the heater and fun
+///          limits, invalid profiles stay in the list (so the menu matches
+///          the provisioning) but can't be loaded and raise
+///          WARNING_CODE_PROFILE_ERROR.
+///          Profiles in the legacy fixed-slot format (memory map 0x0002 and
+///          older) are converted once at start up.
 //  ***************************************************************************
 #include "profiles.h"
+#include "common/le_bytes.h"
+
+
+// Legacy format: 10 fixed slots of name (EOL or 0xFF padded) and 3 stages,
+// the first zero duration stage ends the profile
+#define LEGACY_PROFILE_NAME_SIZE                    (18)
+#define LEGACY_PROFILE_STAGE_TEMPERATURE_C_OFFSET   (0)     // u16
+#define LEGACY_PROFILE_STAGE_DURATION_S_OFFSET      (2)     // u32
+#define LEGACY_PROFILE_STAGE_FUN_PERIOD_S_OFFSET    (6)     // u32
+#define LEGACY_PROFILE_STAGE_FUN_DUTY_CYCLE_OFFSET  (10)    // u16
+#define LEGACY_PROFILE_STAGE_SIZE                   (12)
+#define LEGACY_PROFILE_STAGES_QTY                   (3)
+#define LEGACY_PROFILE_SIZE                         (LEGACY_PROFILE_NAME_SIZE + (LEGACY_PROFILE_STAGE_SIZE * LEGACY_PROFILE_STAGES_QTY))
+#define LEGACY_PROFILES_QTY                         (10)
 
 
-profile_t profiles[RG_PROFILES_QTY];
 uint8_t active_profiles_qty; 
 
 
+static uint16_t profiles_offsets[RG_PROFILES_QTY];
+static uint32_t profiles_index_seq;
+static uint16_t profiles_invalid_mask;
+
+
+static void profiles_migrate_legacy(void);
+static void profiles_index(void);
+static bool profile_parse(const uint8_t *data, uint32_t *offset, profile_plan_t *plan);
+static bool profile_validate(const profile_plan_t *plan);
+static uint32_t clamp(uint32_t value, uint32_t max);
+
+
+
 
 void profiles_init(void) {
-    uint32_t flash_address, i, j;
-
-
-    // Load profiles from flash
-    flash_address = 0;
-    for (i = 0; i < RG_PROFILES_QTY; i++) {
-        flash_read_bytes(flash_address, profiles[i].name, RG_PROFILE_NAME_SIZE);
-        profiles[i].name[RG_PROFILE_NAME_SIZE] = '\0';    // guaranted EOL
-        flash_address += RG_PROFILE_NAME_SIZE;
-
-        for (j = 0; j < RG_PROFILE_STAGES_QTY; j++) {
-            flash_read_u16(flash_address, &profiles[i].stages[j].temperature_c);
-            flash_address += RG_PROFILE_STAGE_TEMPERATURE_C_SIZE;
-            flash_read_u32(flash_address, &profiles[i].stages[j].duration_s);
-            flash_address += RG_PROFILE_STAGE_DURATION_S_SIZE;
-            flash_read_u32(flash_address, &profiles[i].stages[j].fun_period_s);
-            flash_address += RG_PROFILE_STAGE_FUN_PERIOD_S_SIZE;
-            flash_read_u16(flash_address, &profiles[i].stages[j].fun_duty_cycle_pct);
-            flash_address += RG_PROFILE_STAGE_FUN_DUTY_CYCLE_PCT_SIZE;
+    profiles_migrate_legacy();
+    profiles_index();
+    if (active_profiles_qty == 0) eh_set_fail_cfg_error();
+}
+
+
+void profiles_process(void) {
+    if (flash_get_active_seq() != profiles_index_seq) profiles_index();
+}
+
+
+//  ***************************************************************************
+/// @brief  Get profile name
+/// @param  index - profile index
+/// @param  name - RG_PROFILE_NAME_SIZE + 1 bytes buffer, can't be NULL
+/// @retval name - EOL terminated
+/// @return true - success, false - no profile
+//  ***************************************************************************
+bool profiles_get_name(uint8_t index, uint8_t *name) {
+    const uint8_t *profile_data;
+    uint32_t name_size;
+
+
+    if (index >= active_profiles_qty) return false;
+    profile_data = flash_get_data_ptr() + profiles_offsets[index];
+    name_size = profile_data[RG_PROFILE_HDR_NAME_SIZE_OFFSET];
+    memcpy(name, &profile_data[RG_PROFILE_HDR_SIZE], name_size);
+    name[name_size] = '\0';
+    return true;
+}
+
+
+//  ***************************************************************************
+/// @brief  Get profile validation result
+/// @param  index - profile index
+/// @return true - profile can be run, false - invalid or no profile
+//  ***************************************************************************
+bool profiles_is_valid(uint8_t index) {
+    if (index >= active_profiles_qty) return false;
+    return ((profiles_invalid_mask & (1 << index)) == 0);
+}
+
+
+//  ***************************************************************************
+/// @brief  Build profile run plan
+/// @param  index - profile index
+/// @param  plan - pointer, can't be NULL
+/// @retval plan - stages setpoints with absolute end times
+/// @return true - success, false - invalid or no profile
+//  ***************************************************************************
+bool profiles_load(uint8_t index, profile_plan_t *plan) {
+    uint32_t offset;
+
+
+    if (!profiles_is_valid(index)) return false;
+    offset = profiles_offsets[index];
+    return profile_parse(flash_get_data_ptr(), &offset, plan);
+}
+
+
+
+
+//  ***************************************************************************
+/// @brief  Convert legacy fixed-slot profiles to variable-length format
+/// @param  none
+/// @return none
+/// @note   Legacy area starts with name (printable symbol), new format starts
+///         with name size (1..RG_PROFILE_NAME_SIZE). Source is the active
+///         copy, result is built in RAM shadow and committed to the other one.
+//  ***************************************************************************
+static void profiles_migrate_legacy(void) {
+    uint8_t stage[RG_PROFILE_STAGE_SIZE + RG_PROFILE_STAGE_FUN_SIZE];
+    uint8_t header[RG_PROFILE_HDR_SIZE];
+    const uint8_t *data, *legacy_profile, *legacy_stage;
+    uint32_t address, name_size, stages_qty, stage_size, fun_period_s, i, j;
+
+
+    // No valid copy: nothing to convert
+    if (fail_code & FAIL_CODE_CFG_ERROR) return;
+    data = flash_get_data_ptr();
+    if ((data[0] < ' ') || (data[0] == 0xFF)) return;
+
+    flash_erase();
+    address = 0;
+    for (i = 0; i < LEGACY_PROFILES_QTY; i++) {
+        legacy_profile = &data[i * LEGACY_PROFILE_SIZE];
+        if ((legacy_profile[0] == '\0') || (legacy_profile[0] == 0xFF)) break;
+
+        for (name_size = 0; name_size < LEGACY_PROFILE_NAME_SIZE; name_size++) {
+            if ((legacy_profile[name_size] == '\0') || (legacy_profile[name_size] == 0xFF)) break;
+        }
+        for (stages_qty = 0; stages_qty < LEGACY_PROFILE_STAGES_QTY; stages_qty++) {
+            legacy_stage = &legacy_profile[LEGACY_PROFILE_NAME_SIZE + (stages_qty * LEGACY_PROFILE_STAGE_SIZE)];
+            if (le_get_u32(&legacy_stage[LEGACY_PROFILE_STAGE_DURATION_S_OFFSET]) == 0) break;
+        }
+        // Nothing to run, legacy menu showed it but the run ended at once
+        if (stages_qty == 0) continue;
+
+        header[RG_PROFILE_HDR_NAME_SIZE_OFFSET] = name_size;
+        header[RG_PROFILE_HDR_STAGES_QTY_OFFSET] = stages_qty;
+        flash_write_bytes(address, header, RG_PROFILE_HDR_SIZE);
+        address += RG_PROFILE_HDR_SIZE;
+        flash_write_bytes(address, legacy_profile, name_size);
+        address += name_size;
+
+        // Out of range values are clamped, profile validation reports them
+        for (j = 0; j < stages_qty; j++) {
+            legacy_stage = &legacy_profile[LEGACY_PROFILE_NAME_SIZE + (j * LEGACY_PROFILE_STAGE_SIZE)];
+            fun_period_s = le_get_u32(&legacy_stage[LEGACY_PROFILE_STAGE_FUN_PERIOD_S_OFFSET]);
+            stage[RG_PROFILE_STAGE_FLAGS_OFFSET] = (fun_period_s > 0) ? RG_PROFILE_STAGE_FLAG_FUN : 0;
+            stage[RG_PROFILE_STAGE_TEMPERATURE_C_OFFSET] = clamp(le_get_u16(&legacy_stage[LEGACY_PROFILE_STAGE_TEMPERATURE_C_OFFSET]), UINT8_MAX);
+            le_put_u16(&stage[RG_PROFILE_STAGE_DURATION_S_OFFSET], clamp(le_get_u32(&legacy_stage[LEGACY_PROFILE_STAGE_DURATION_S_OFFSET]), UINT16_MAX));
+            stage_size = RG_PROFILE_STAGE_SIZE;
+            if (fun_period_s > 0) {
+                le_put_u16(&stage[RG_PROFILE_STAGE_SIZE + RG_PROFILE_STAGE_FUN_PERIOD_S_OFFSET], clamp(fun_period_s, UINT16_MAX));
+                stage[RG_PROFILE_STAGE_SIZE + RG_PROFILE_STAGE_FUN_DUTY_CYCLE_PCT_OFFSET] = clamp(le_get_u16(&legacy_stage[LEGACY_PROFILE_STAGE_FUN_DUTY_CYCLE_OFFSET]), UINT8_MAX);
+                stage_size += RG_PROFILE_STAGE_FUN_SIZE;
+            }
+            flash_write_bytes(address, stage, stage_size);
+            address += stage_size;
         }
     }
 
-    // Check profiles
+    flash_commit();
+}
+
+
+static void profiles_index(void) {
+    profile_plan_t plan;
+    const uint8_t *data;
+    uint32_t offset;
+
+
+    profiles_index_seq = flash_get_active_seq();
+    profiles_invalid_mask = 0;
+    data = flash_get_data_ptr();
+    offset = 0;
     for (active_profiles_qty = 0; active_profiles_qty < RG_PROFILES_QTY; active_profiles_qty++) {
-        if ((profiles[active_profiles_qty].name[0] == '\0') || (profiles[active_profiles_qty].name[0] == 0xFF)) break;
+        profiles_offsets[active_profiles_qty] = offset;
+        if (!profile_parse(data, &offset, &plan)) break;
+        if (!profile_validate(&plan)) profiles_invalid_mask |= (1 << active_profiles_qty);
     }
 
-    if (active_profiles_qty == 0) eh_set_fail_cfg_error();
+    if (profiles_invalid_mask != 0) eh_set_warn_profile_error(profiles_invalid_mask);
+    else eh_clear_warn_profile_error();
+}
+
+
+//  ***************************************************************************
+/// @brief  Check profile format and build run plan
+/// @param  data - profiles area
+/// @param  offset - profile offset, pointer, can't be NULL
+/// @param  plan - pointer, can't be NULL
+/// @retval offset - next profile offset
+/// @retval plan
+/// @return true - success, false - profile is broken or absent
+//  ***************************************************************************
+static bool profile_parse(const uint8_t *data, uint32_t *offset, profile_plan_t *plan) {
+    const uint8_t *stage;
+    uint32_t address, name_size, stages_qty, i;
+
+
+    address = *offset;
+    if ((address + RG_PROFILE_HDR_SIZE) > RG_FLASH_RW_REG_PROFILES_AREA_SIZE) return false;
+    name_size = data[address + RG_PROFILE_HDR_NAME_SIZE_OFFSET];
+    if ((name_size == 0) || (name_size > RG_PROFILE_NAME_SIZE)) return false;
+    stages_qty = data[address + RG_PROFILE_HDR_STAGES_QTY_OFFSET];
+    if ((stages_qty == 0) || (stages_qty > RG_PROFILE_STAGES_QTY)) return false;
+    address += RG_PROFILE_HDR_SIZE + name_size;
+
+    plan->stages_qty = stages_qty;
+    plan->total_time_s = 0;
+    for (i = 0; i < stages_qty; i++) {
+        if ((address + RG_PROFILE_STAGE_SIZE) > RG_FLASH_RW_REG_PROFILES_AREA_SIZE) return false;
+        stage = &data[address];
+        address += RG_PROFILE_STAGE_SIZE;
+        if (stage[RG_PROFILE_STAGE_FLAGS_OFFSET] & RG_PROFILE_STAGE_FLAG_FUN) address += RG_PROFILE_STAGE_FUN_SIZE;
+        if (address > RG_FLASH_RW_REG_PROFILES_AREA_SIZE) return false;
+
+        plan->total_time_s += le_get_u16(&stage[RG_PROFILE_STAGE_DURATION_S_OFFSET]);
+        plan->stages[i].end_time_s = plan->total_time_s;
+        plan->stages[i].temperature_c = stage[RG_PROFILE_STAGE_TEMPERATURE_C_OFFSET];
+        plan->stages[i].fun_period_s = 0;
+        plan->stages[i].fun_duty_cycle_pct = 0;
+
+        // Optional fields
+        if (stage[RG_PROFILE_STAGE_FLAGS_OFFSET] & RG_PROFILE_STAGE_FLAG_FUN) {
+            plan->stages[i].fun_period_s = le_get_u16(&stage[RG_PROFILE_STAGE_SIZE + RG_PROFILE_STAGE_FUN_PERIOD_S_OFFSET]);
+            plan->stages[i].fun_duty_cycle_pct = stage[RG_PROFILE_STAGE_SIZE + RG_PROFILE_STAGE_FUN_DUTY_CYCLE_PCT_OFFSET];
+        }
+    }
+
+    *offset = address;
+    return true;
+}
+
+
+//  ***************************************************************************
+/// @brief  Check run plan against outputs limits
+/// @note   Out of range values would be silently clamped by heater_en() /
+///         fun_en() and a zero duration stage would end the run early
+/// @param  plan - pointer, can't be NULL
+/// @return true - plan is valid
+//  ***************************************************************************
+static bool profile_validate(const profile_plan_t *plan) {
+    uint32_t stage_start_time_s, i;
+
+
+    stage_start_time_s = 0;
+    for (i = 0; i < plan->stages_qty; i++) {
+        if (plan->stages[i].end_time_s <= stage_start_time_s) return false;
+        if (plan->stages[i].temperature_c > HEATER_MAX_TEMP_C) return false;
+        if (plan->stages[i].fun_duty_cycle_pct > PROFILE_FUN_DUTY_CYCLE_MAX_PCT) return false;
+        stage_start_time_s = plan->stages[i].end_time_s;
+    }
+    return true;
+}
+
+
+static uint32_t clamp(uint32_t value, uint32_t max) {
+    return (value > max) ? max : value;
 }
@@ -10,27 +10,36 @@
 #include <stdlib.h>
 #include "registers.h"
 #include "flash.h"
+#include "outputs_driver.h"
 #include "error_handling.h"
 
 
+#define PROFILE_FUN_DUTY_CYCLE_MAX_PCT      (100)
+
+
 typedef struct {
-    uint16_t temperature_c;
-    uint32_t duration_s;
-    uint32_t fun_period_s;
-    uint16_t fun_duty_cycle_pct;
-} profile_stage_t;
+    uint32_t end_time_s;            // From the process start
+    uint16_t fun_period_s;
+    uint8_t  temperature_c;
+    uint8_t  fun_duty_cycle_pct;
+} profile_plan_stage_t;
 
 typedef struct {
-    uint8_t name[RG_PROFILE_NAME_SIZE + 1];
-    profile_stage_t stages[RG_PROFILE_STAGES_QTY];
-} profile_t;
+    uint32_t total_time_s;
+    uint8_t  stages_qty;
+    profile_plan_stage_t stages[RG_PROFILE_STAGES_QTY];
+} profile_plan_t;
 
 
-extern profile_t profiles[RG_PROFILES_QTY];
 extern uint8_t active_profiles_qty;
 
 
 extern void profiles_init(void);
+extern void profiles_process(void);
+
+extern bool profiles_get_name(uint8_t index, uint8_t *name);
+extern bool profiles_is_valid(uint8_t index);
+extern bool profiles_load(uint8_t index, profile_plan_t *plan);
 
 
 #endif   // _PROFILES_H_
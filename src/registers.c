@@ -5,32 +5,69 @@
 #include "common/mcu.h"
 #include "error_handling.h"
 #include "flash.h"
+#include "eeprom_emul.h"
+#include "outputs_driver.h"
+#include "event_journal.h"
+#include "vdda_monitor.h"
+
+
+#if ((RG_FLASH_REGS_QTY * 2) > FLASH_SHADOW_SIZE)
+#error "FLASH registers don't fit to FLASH RAM shadow"
+#endif
+#if (RG_EE_REGS_QTY > EEPROM_EMUL_VARS_QTY)
+#error "EEPROM registers don't fit to EEPROM emulation"
+#endif
+#if (RG_JOURNAL_RW_REG_EVENT_INDEX_MAX != (EVENT_JOURNAL_SIZE - 1))
+#error "EVENT_INDEX max in registers.yaml doesn't match EVENT_JOURNAL_SIZE"
+#endif
 
 
 uint16_t registers_ram[RG_RAM_REGS_QTY];
 
 
+static const regs_descriptor_t *regs_find(uint32_t address);
+static bool regs_check_write(uint32_t address, uint32_t regs_qty, const uint16_t *regs_values);
+static bool regs_ee_get(uint32_t address, uint16_t *reg_value);
+static bool regs_ee_set(uint32_t address, uint16_t reg_value);
+static void regs_update_event(void);
+static void regs_update_vdda(void);
+
 
 
 void regs_init(void) {
-    registers_ram[RG_RAM_RO_REG_MEMORY_MAP_VERSION] = 0x0001;
-    registers_ram[RG_RAM_RO_REG_DEVIE_ID_0] = 0x0001;
-    registers_ram[RG_RAM_RO_REG_DEVIE_ID_1] = 0x0000;
-    registers_ram[RG_RAM_RO_REG_DEVIE_VER_MINOR] = 0x0001;
-    registers_ram[RG_RAM_RO_REG_DEVIE_VER_MAJOR] = 0x0001;
-    registers_ram[RG_RAM_RO_REG_FAIL_CODE] = 0x0000;
-    registers_ram[RG_RAM_RO_REG_WARN_CODE] = 0x0000;
-
-    registers_ram[RG_RAM_RW_REG_CMD] = 0x0000;
+    uint32_t address;
+    uint16_t reg_value;
+
+
+    registers_ram[RG_RAM_RO_REG_MEMORY_MAP_VERSION_RAM_INDEX] = RG_MEMORY_MAP_VERSION;
+    registers_ram[RG_RAM_RO_REG_DEVIE_ID_0_RAM_INDEX] = 0x0001;
+    registers_ram[RG_RAM_RO_REG_DEVIE_ID_1_RAM_INDEX] = 0x0000;
+    registers_ram[RG_RAM_RO_REG_DEVIE_VER_MINOR_RAM_INDEX] = 0x0001;
+    registers_ram[RG_RAM_RO_REG_DEVIE_VER_MAJOR_RAM_INDEX] = 0x0001;
+    registers_ram[RG_RAM_RO_REG_FAIL_CODE_RAM_INDEX] = 0x0000;
+    registers_ram[RG_RAM_RO_REG_WARN_CODE_RAM_INDEX] = 0x0000;
+
+    registers_ram[RG_RAM_RW_REG_CMD_RAM_INDEX] = 0x0000;
+    registers_ram[RG_JOURNAL_RW_REG_EVENT_INDEX_RAM_INDEX] = 0x0000;
+
+    // Apply stored parameters, not stored ones keep default values
+    eeprom_emul_init();
+    for (address = RG_EE_REGS_ADDR_OFFSET; address < (RG_EE_REGS_ADDR_OFFSET + RG_EE_REGS_QTY); address++) {
+        if (!eeprom_emul_read((address - RG_EE_REGS_ADDR_OFFSET), &reg_value)) continue;
+        if (regs_check_write(address, 1, &reg_value)) regs_ee_set(address, reg_value);
+    }
 }
 
 
 void regs_process(void) {
-    registers_ram[RG_RAM_RO_REG_FAIL_CODE] = fail_code;
-    registers_ram[RG_RAM_RO_REG_WARN_CODE] = warning_code;
+    registers_ram[RG_RAM_RO_REG_FAIL_CODE_RAM_INDEX] = fail_code;
+    registers_ram[RG_RAM_RO_REG_WARN_CODE_RAM_INDEX] = warning_code;
+    regs_update_event();
+    regs_update_vdda();
 
-    switch (registers_ram[RG_RAM_RW_REG_CMD]) {
+    switch (registers_ram[RG_RAM_RW_REG_CMD_RAM_INDEX]) {
         case RG_CMD_REBOOT:
+            if (flash_is_dirty()) flash_commit();
             NVIC_SystemReset();
             break;
 
@@ -38,79 +75,272 @@ void regs_process(void) {
             flash_erase();
             break;
 
-        case RG_CMD_UPDATE_FLASH_CRC:
-            flash_update_crc();
+        case RG_CMD_FLASH_COMMIT:
+            flash_commit();
             break;
 
         default:
             break;
     }
-    registers_ram[RG_RAM_RW_REG_CMD] = 0;
+    registers_ram[RG_RAM_RW_REG_CMD_RAM_INDEX] = 0;
 }
 
 
 bool regs_read_reg(uint32_t address, uint16_t *reg_value) {
-    uint32_t flash_addr;
-
+    return regs_read_regs(address, 1, reg_value);
+}
 
-    if (address > RG_MAX_REG_ADDR) return false;
 
-    if (address < RG_FLASH_REGS_ADDR_OFFSET) {
-        *reg_value = registers_ram[address];
+//  ***************************************************************************
+/// @brief  Read registers
+/// @param  address - the first register address
+/// @param  regs_qty
+/// @param  regs_values - buffer for regs_qty values, can't be NULL
+/// @retval regs_values
+/// @return true - success, false - registers aren't mapped
+/// @note   Every descriptor covered by the range is accessed by one block
+//  ***************************************************************************
+bool regs_read_regs(uint32_t address, uint32_t regs_qty, uint16_t *regs_values) {
+    const regs_descriptor_t *descriptor;
+    uint32_t index, qty, i;
+
+
+    while (regs_qty > 0) {
+        descriptor = regs_find(address);
+        if (descriptor == NULL) return false;
+        index = address - descriptor->address;
+        qty = descriptor->qty - index;
+        if (qty > regs_qty) qty = regs_qty;
+
+        switch (descriptor->storage) {
+            case RG_STORAGE_RAM:
+                memcpy(regs_values, &registers_ram[descriptor->storage_address + index], (qty * 2));
+                break;
+
+            case RG_STORAGE_FLASH:
+                if (!flash_read_bytes((descriptor->storage_address + (index * 2)), (uint8_t*)regs_values, (qty * 2))) return false;
+                break;
+
+            default:
+                for (i = 0; i < qty; i++) {
+                    if (!regs_ee_get((address + i), &regs_values[i])) return false;
+                }
+                break;
+        }
+
+        address += qty;
+        regs_values += qty;
+        regs_qty -= qty;
     }
-    else {
-        flash_addr = (address - RG_FLASH_REGS_ADDR_OFFSET) * 2;
-        return flash_read_u16(flash_addr, reg_value);
+    return true;
+}
+
+
+bool regs_write_reg(uint32_t address, uint16_t reg_value) {
+    return regs_write_regs(address, 1, &reg_value);
+}
+
+
+//  ***************************************************************************
+/// @brief  Write registers
+/// @param  address - the first register address
+/// @param  regs_qty
+/// @param  regs_values - regs_qty values, can't be NULL
+/// @return true - success, false - registers aren't mapped, are read-only or
+///         value is out of range
+/// @note   The whole range is checked before the first write: nothing is
+///         written if any register can't be written
+//  ***************************************************************************
+bool regs_write_regs(uint32_t address, uint32_t regs_qty, const uint16_t *regs_values) {
+    const regs_descriptor_t *descriptor;
+    uint32_t index, qty, i;
+
+
+    if (!regs_check_write(address, regs_qty, regs_values)) return false;
+
+    while (regs_qty > 0) {
+        descriptor = regs_find(address);
+        index = address - descriptor->address;
+        qty = descriptor->qty - index;
+        if (qty > regs_qty) qty = regs_qty;
+
+        switch (descriptor->storage) {
+            case RG_STORAGE_RAM:
+                memcpy(&registers_ram[descriptor->storage_address + index], regs_values, (qty * 2));
+                break;
+
+            case RG_STORAGE_FLASH:
+                if (!flash_write_bytes((descriptor->storage_address + (index * 2)), (const uint8_t*)regs_values, (qty * 2))) return false;
+                break;
+
+            default:
+                for (i = 0; i < qty; i++) {
+                    if (!regs_ee_set((address + i), regs_values[i])) return false;
+                    if (!eeprom_emul_write((descriptor->storage_address + index + i), regs_values[i])) return false;
+                }
+                break;
+        }
+
+        address += qty;
+        regs_values += qty;
+        regs_qty -= qty;
     }
     return true;
 }
 
 
-bool regs_read_regs(uint32_t address, uint32_t regs_qty, uint16_t *regs_values) {
-    uint32_t buff_index;
 
 
-    if ((address + regs_qty) > RG_MAX_REG_ADDR) return false;
+//  ***************************************************************************
+/// @brief  Find register descriptor
+/// @param  address - register address
+/// @return descriptor, NULL - register isn't mapped
+/// @note   Binary search, descriptors are sorted by address
+//  ***************************************************************************
+static const regs_descriptor_t *regs_find(uint32_t address) {
+    int32_t low, high, middle;
 
-    for (buff_index = 0; buff_index < regs_qty; buff_index++) {
-        if (!regs_read_reg(address, &regs_values[buff_index])) return false;
-        address++;
+
+    low = 0;
+    high = RG_DESCRIPTORS_QTY - 1;
+    while (low <= high) {
+        middle = (low + high) / 2;
+        if (address < regs_descriptors[middle].address) high = middle - 1;
+        else if (address >= (uint32_t)(regs_descriptors[middle].address + regs_descriptors[middle].qty)) low = middle + 1;
+        else return &regs_descriptors[middle];
     }
-    return true;
+    return NULL;
 }
 
 
-bool regs_write_reg(uint32_t address, uint16_t reg_value) {
-    uint32_t flash_addr;
+static bool regs_check_write(uint32_t address, uint32_t regs_qty, const uint16_t *regs_values) {
+    const regs_descriptor_t *descriptor;
+    uint32_t index, qty, i;
+
 
+    while (regs_qty > 0) {
+        descriptor = regs_find(address);
+        if ((descriptor == NULL) || (descriptor->access != RG_ACCESS_RW)) return false;
+        index = address - descriptor->address;
+        qty = descriptor->qty - index;
+        if (qty > regs_qty) qty = regs_qty;
 
-    if (address > RG_MAX_REG_ADDR) return false;
-    if (address < RG_RAM_RW_REGS_ADDR_OFFSET) return false;  // RAM RO space
-    if ((address > RG_RAM_RW_REGS_ADDR_OFFSET) && (address < RG_FLASH_RW_REGS_ADDR_OFFSET)) return false;  // Flash RO space
+        if (descriptor->type == RG_TYPE_U16) {
+            for (i = 0; i < qty; i++) {
+                if ((regs_values[i] < descriptor->min) || (regs_values[i] > descriptor->max)) return false;
+            }
+        }
 
-    if (address < RG_FLASH_REGS_ADDR_OFFSET) {
-        registers_ram[address] = reg_value;
+        address += qty;
+        regs_values += qty;
+        regs_qty -= qty;
     }
-    else {
-        flash_addr = (address - RG_FLASH_REGS_ADDR_OFFSET) * 2;
-        return flash_write_u16(flash_addr, reg_value);
+    return true;
+}
+
+
+static bool regs_ee_get(uint32_t address, uint16_t *reg_value) {
+    switch (address) {
+        case RG_EE_REG_HEATER_ACTIVE_TIME_MS_LO:
+            *reg_value = (uint16_t)heater_active_time_ms;
+            break;
+
+        case RG_EE_REG_HEATER_ACTIVE_TIME_MS_HI:
+            *reg_value = (uint16_t)(heater_active_time_ms >> 16);
+            break;
+
+        case RG_EE_REG_HEATER_DELAY_TIME_MS_LO:
+            *reg_value = (uint16_t)heater_delay_time_ms;
+            break;
+
+        case RG_EE_REG_HEATER_DELAY_TIME_MS_HI:
+            *reg_value = (uint16_t)(heater_delay_time_ms >> 16);
+            break;
+
+        case RG_EE_REG_HEATER_HIST_ON_C:
+            *reg_value = heater_hist_on_c;
+            break;
+
+        case RG_EE_REG_HEATER_HIST_OFF_C:
+            *reg_value = heater_hist_off_c;
+            break;
+
+        default:
+            return false;
     }
     return true;
 }
 
 
-bool regs_write_regs(uint32_t address, uint32_t regs_qty, const uint16_t *regs_values) {
-    uint32_t buff_index;
+static bool regs_ee_set(uint32_t address, uint16_t reg_value) {
+    switch (address) {
+        case RG_EE_REG_HEATER_ACTIVE_TIME_MS_LO:
+            heater_active_time_ms = (heater_active_time_ms & 0xFFFF0000) | reg_value;
+            break;
+
+        case RG_EE_REG_HEATER_ACTIVE_TIME_MS_HI:
+            heater_active_time_ms = (heater_active_time_ms & 0x0000FFFF) | ((uint32_t)reg_value << 16);
+            break;
+
+        case RG_EE_REG_HEATER_DELAY_TIME_MS_LO:
+            heater_delay_time_ms = (heater_delay_time_ms & 0xFFFF0000) | reg_value;
+            break;
+
+        case RG_EE_REG_HEATER_DELAY_TIME_MS_HI:
+            heater_delay_time_ms = (heater_delay_time_ms & 0x0000FFFF) | ((uint32_t)reg_value << 16);
+            break;
 
+        case RG_EE_REG_HEATER_HIST_ON_C:
+            heater_hist_on_c = reg_value;
+            break;
 
-    if ((address + regs_qty) > RG_MAX_REG_ADDR) return false;
-    if (address < RG_RAM_RW_REGS_ADDR_OFFSET) return false;  // RAM RO space included
-    if ((address > RG_RAM_RW_REGS_ADDR_OFFSET) && (address < RG_FLASH_RW_REGS_ADDR_OFFSET)) return false;  // Flash RO space included
-    if ((address < RG_FLASH_RO_REGS_ADDR_OFFSET) && ((address + regs_qty) > RG_FLASH_RO_REGS_ADDR_OFFSET)) return false;  // Flash RO space included
+        case RG_EE_REG_HEATER_HIST_OFF_C:
+            heater_hist_off_c = reg_value;
+            break;
 
-    for (buff_index = 0; buff_index < regs_qty; buff_index++) {
-        if (!regs_write_reg(address, regs_values[buff_index])) return false;
-        address++;
+        default:
+            return false;
     }
     return true;
 }
+
+
+//  ***************************************************************************
+/// @brief  Update events journal registers by selected entry
+/// @param  none
+/// @return none
+/// @note   Absent entry reads as zeros
+//  ***************************************************************************
+static void regs_update_event(void) {
+    event_journal_entry_t entry;
+
+
+    if (!event_journal_read(registers_ram[RG_JOURNAL_RW_REG_EVENT_INDEX_RAM_INDEX], &entry)) {
+        memset(&entry, 0, sizeof(entry));
+    }
+
+    registers_ram[RG_JOURNAL_RO_REG_EVENTS_QTY_RAM_INDEX] = (uint16_t)event_journal_get_qty();
+    registers_ram[RG_JOURNAL_RO_REG_EVENT_TIME_MS_LO_RAM_INDEX] = (uint16_t)entry.time_ms;
+    registers_ram[RG_JOURNAL_RO_REG_EVENT_TIME_MS_HI_RAM_INDEX] = (uint16_t)(entry.time_ms >> 16);
+    registers_ram[RG_JOURNAL_RO_REG_EVENT_SOURCE_RAM_INDEX] = entry.source | (entry.is_prev_boot ? 0x0100 : 0);
+    registers_ram[RG_JOURNAL_RO_REG_EVENT_FLAG_RAM_INDEX] = entry.flag;
+    registers_ram[RG_JOURNAL_RO_REG_EVENT_CODE_LO_RAM_INDEX] = (uint16_t)entry.code;
+    registers_ram[RG_JOURNAL_RO_REG_EVENT_CODE_HI_RAM_INDEX] = (uint16_t)(entry.code >> 16);
+    registers_ram[RG_JOURNAL_RO_REG_EVENT_CONTEXT_LO_RAM_INDEX] = (uint16_t)entry.context;
+    registers_ram[RG_JOURNAL_RO_REG_EVENT_CONTEXT_HI_RAM_INDEX] = (uint16_t)(entry.context >> 16);
+}
+
+
+static void regs_update_vdda(void) {
+    vdda_monitor_stat_t stat;
+
+
+    vdda_monitor_get_stat(&stat);
+    registers_ram[RG_VDDA_REG_MV_RAM_INDEX] = stat.vdda_mv;
+    registers_ram[RG_VDDA_REG_MIN_MV_RAM_INDEX] = stat.min_mv;
+    registers_ram[RG_VDDA_REG_AVG_MV_RAM_INDEX] = stat.avg_mv;
+    registers_ram[RG_VDDA_REG_MAX_MV_RAM_INDEX] = stat.max_mv;
+    registers_ram[RG_VDDA_REG_HEATER_ON_MIN_MV_RAM_INDEX] = stat.heater_on_min_mv;
+    registers_ram[RG_VDDA_REG_SAGS_QTY_RAM_INDEX] = stat.sags_qty;
+    registers_ram[RG_VDDA_REG_HEATER_SAGS_QTY_RAM_INDEX] = stat.heater_sags_qty;
+}
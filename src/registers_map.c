@@ -0,0 +1,42 @@
+//  ***************************************************************************
+/// @file    registers_map.c
+/// @note    Generated by regs_gen.py from registers.yaml, don't edit
+//  ***************************************************************************
+#include "registers.h"
+
+
+// Sorted by address
+const regs_descriptor_t regs_descriptors[RG_DESCRIPTORS_QTY] = {
+    {RG_RAM_RO_REG_MEMORY_MAP_VERSION, 1, 0, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_RAM_RO_REG_DEVIE_ID_0, 1, 1, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_RAM_RO_REG_DEVIE_ID_1, 1, 2, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_RAM_RO_REG_DEVIE_VER_MINOR, 1, 3, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_RAM_RO_REG_DEVIE_VER_MAJOR, 1, 4, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_RAM_RO_REG_FAIL_CODE, 1, 5, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_RAM_RO_REG_WARN_CODE, 1, 6, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_RAM_RW_REG_CMD, 1, 7, 0x0000, 0x0003, RG_STORAGE_RAM, RG_ACCESS_RW, RG_TYPE_U16},
+    {RG_FLASH_RW_REG_PROFILES_AREA, 270, 0, 0x0000, 0xFFFF, RG_STORAGE_FLASH, RG_ACCESS_RW, RG_TYPE_BYTES},
+    {RG_EE_REG_HEATER_ACTIVE_TIME_MS_LO, 1, 0, 0x0000, 0xFFFF, RG_STORAGE_EE, RG_ACCESS_RW, RG_TYPE_U16},
+    {RG_EE_REG_HEATER_ACTIVE_TIME_MS_HI, 1, 1, 0x0000, 0xFFFF, RG_STORAGE_EE, RG_ACCESS_RW, RG_TYPE_U16},
+    {RG_EE_REG_HEATER_DELAY_TIME_MS_LO, 1, 2, 0x0000, 0xFFFF, RG_STORAGE_EE, RG_ACCESS_RW, RG_TYPE_U16},
+    {RG_EE_REG_HEATER_DELAY_TIME_MS_HI, 1, 3, 0x0000, 0xFFFF, RG_STORAGE_EE, RG_ACCESS_RW, RG_TYPE_U16},
+    {RG_EE_REG_HEATER_HIST_ON_C, 1, 4, 0x0000, 0x00FF, RG_STORAGE_EE, RG_ACCESS_RW, RG_TYPE_U16},
+    {RG_EE_REG_HEATER_HIST_OFF_C, 1, 5, 0x0000, 0x00FF, RG_STORAGE_EE, RG_ACCESS_RW, RG_TYPE_U16},
+    {RG_JOURNAL_RW_REG_EVENT_INDEX, 1, 8, 0x0000, 0x0007, RG_STORAGE_RAM, RG_ACCESS_RW, RG_TYPE_U16},
+    {RG_JOURNAL_RO_REG_EVENTS_QTY, 1, 9, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_JOURNAL_RO_REG_EVENT_TIME_MS_LO, 1, 10, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_JOURNAL_RO_REG_EVENT_TIME_MS_HI, 1, 11, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_JOURNAL_RO_REG_EVENT_SOURCE, 1, 12, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_JOURNAL_RO_REG_EVENT_FLAG, 1, 13, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_JOURNAL_RO_REG_EVENT_CODE_LO, 1, 14, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_JOURNAL_RO_REG_EVENT_CODE_HI, 1, 15, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_JOURNAL_RO_REG_EVENT_CONTEXT_LO, 1, 16, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_JOURNAL_RO_REG_EVENT_CONTEXT_HI, 1, 17, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_VDDA_REG_MV, 1, 18, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_VDDA_REG_MIN_MV, 1, 19, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_VDDA_REG_AVG_MV, 1, 20, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_VDDA_REG_MAX_MV, 1, 21, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_VDDA_REG_HEATER_ON_MIN_MV, 1, 22, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_VDDA_REG_SAGS_QTY, 1, 23, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+    {RG_VDDA_REG_HEATER_SAGS_QTY, 1, 24, 0x0000, 0xFFFF, RG_STORAGE_RAM, RG_ACCESS_RO, RG_TYPE_U16},
+};
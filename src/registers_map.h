@@ -0,0 +1,124 @@
+//  ***************************************************************************
+/// @file    registers_map.h
+/// @brief   Registers map
+/// @note    Generated by regs_gen.py from registers.yaml, don't edit
+//  ***************************************************************************
+#ifndef _REGISTERS_MAP_H_
+#define _REGISTERS_MAP_H_
+
+
+#define RG_MEMORY_MAP_VERSION                        (0x0007)
+
+#define RG_RAM_RO_REGS_ADDR_OFFSET                   (0)
+#define RG_RAM_RO_REGS_QTY                           (7)
+#define RG_RAM_RW_REGS_ADDR_OFFSET                   (7)
+#define RG_RAM_RW_REGS_QTY                           (1)
+#define RG_FLASH_RW_REGS_ADDR_OFFSET                 (8)
+#define RG_FLASH_RW_REGS_QTY                         (270)
+#define RG_EE_REGS_ADDR_OFFSET                       (1024)
+#define RG_EE_REGS_QTY                               (6)
+#define RG_JOURNAL_RW_REGS_ADDR_OFFSET               (2048)
+#define RG_JOURNAL_RW_REGS_QTY                       (1)
+#define RG_JOURNAL_RO_REGS_ADDR_OFFSET               (2049)
+#define RG_JOURNAL_RO_REGS_QTY                       (9)
+#define RG_VDDA_REGS_ADDR_OFFSET                     (2304)
+#define RG_VDDA_REGS_QTY                             (7)
+#define RG_RAM_REGS_ADDR_OFFSET                      (0)
+#define RG_RAM_REGS_QTY                              (25)
+#define RG_FLASH_REGS_ADDR_OFFSET                    (8)
+#define RG_FLASH_REGS_QTY                            (270)
+#define RG_MAX_REG_ADDR                              (2310)  // the last register
+#define RG_DESCRIPTORS_QTY                           (32)
+
+#define RG_RAM_RO_REG_MEMORY_MAP_VERSION             (0)
+#define RG_RAM_RO_REG_MEMORY_MAP_VERSION_RAM_INDEX   (0)     // registers_ram[] index
+#define RG_RAM_RO_REG_DEVIE_ID_0                     (1)
+#define RG_RAM_RO_REG_DEVIE_ID_0_RAM_INDEX           (1)     // registers_ram[] index
+#define RG_RAM_RO_REG_DEVIE_ID_1                     (2)
+#define RG_RAM_RO_REG_DEVIE_ID_1_RAM_INDEX           (2)     // registers_ram[] index
+#define RG_RAM_RO_REG_DEVIE_VER_MINOR                (3)
+#define RG_RAM_RO_REG_DEVIE_VER_MINOR_RAM_INDEX      (3)     // registers_ram[] index
+#define RG_RAM_RO_REG_DEVIE_VER_MAJOR                (4)
+#define RG_RAM_RO_REG_DEVIE_VER_MAJOR_RAM_INDEX      (4)     // registers_ram[] index
+#define RG_RAM_RO_REG_FAIL_CODE                      (5)
+#define RG_RAM_RO_REG_FAIL_CODE_RAM_INDEX            (5)     // registers_ram[] index
+#define RG_RAM_RO_REG_WARN_CODE                      (6)
+#define RG_RAM_RO_REG_WARN_CODE_RAM_INDEX            (6)     // registers_ram[] index
+
+#define RG_RAM_RW_REG_CMD                            (7)
+#define RG_RAM_RW_REG_CMD_MAX                        (3)
+#define RG_RAM_RW_REG_CMD_RAM_INDEX                  (7)     // registers_ram[] index
+
+#define RG_FLASH_RW_REG_PROFILES_AREA                (8)
+#define RG_FLASH_RW_REG_PROFILES_AREA_SIZE           (540)   // bytes
+
+#define RG_EE_REG_HEATER_ACTIVE_TIME_MS_LO           (1024)
+#define RG_EE_REG_HEATER_ACTIVE_TIME_MS_HI           (1025)
+#define RG_EE_REG_HEATER_DELAY_TIME_MS_LO            (1026)
+#define RG_EE_REG_HEATER_DELAY_TIME_MS_HI            (1027)
+#define RG_EE_REG_HEATER_HIST_ON_C                   (1028)
+#define RG_EE_REG_HEATER_HIST_ON_C_MAX               (255)
+#define RG_EE_REG_HEATER_HIST_OFF_C                  (1029)
+#define RG_EE_REG_HEATER_HIST_OFF_C_MAX              (255)
+
+#define RG_JOURNAL_RW_REG_EVENT_INDEX                (2048)
+#define RG_JOURNAL_RW_REG_EVENT_INDEX_MAX            (7)
+#define RG_JOURNAL_RW_REG_EVENT_INDEX_RAM_INDEX      (8)     // registers_ram[] index
+
+#define RG_JOURNAL_RO_REG_EVENTS_QTY                 (2049)
+#define RG_JOURNAL_RO_REG_EVENTS_QTY_RAM_INDEX       (9)     // registers_ram[] index
+#define RG_JOURNAL_RO_REG_EVENT_TIME_MS_LO           (2050)
+#define RG_JOURNAL_RO_REG_EVENT_TIME_MS_LO_RAM_INDEX (10)    // registers_ram[] index
+#define RG_JOURNAL_RO_REG_EVENT_TIME_MS_HI           (2051)
+#define RG_JOURNAL_RO_REG_EVENT_TIME_MS_HI_RAM_INDEX (11)    // registers_ram[] index
+#define RG_JOURNAL_RO_REG_EVENT_SOURCE               (2052)
+#define RG_JOURNAL_RO_REG_EVENT_SOURCE_RAM_INDEX     (12)    // registers_ram[] index
+#define RG_JOURNAL_RO_REG_EVENT_FLAG                 (2053)
+#define RG_JOURNAL_RO_REG_EVENT_FLAG_RAM_INDEX       (13)    // registers_ram[] index
+#define RG_JOURNAL_RO_REG_EVENT_CODE_LO              (2054)
+#define RG_JOURNAL_RO_REG_EVENT_CODE_LO_RAM_INDEX    (14)    // registers_ram[] index
+#define RG_JOURNAL_RO_REG_EVENT_CODE_HI              (2055)
+#define RG_JOURNAL_RO_REG_EVENT_CODE_HI_RAM_INDEX    (15)    // registers_ram[] index
+#define RG_JOURNAL_RO_REG_EVENT_CONTEXT_LO           (2056)
+#define RG_JOURNAL_RO_REG_EVENT_CONTEXT_LO_RAM_INDEX (16)    // registers_ram[] index
+#define RG_JOURNAL_RO_REG_EVENT_CONTEXT_HI           (2057)
+#define RG_JOURNAL_RO_REG_EVENT_CONTEXT_HI_RAM_INDEX (17)    // registers_ram[] index
+
+#define RG_VDDA_REG_MV                               (2304)
+#define RG_VDDA_REG_MV_RAM_INDEX                     (18)    // registers_ram[] index
+#define RG_VDDA_REG_MIN_MV                           (2305)
+#define RG_VDDA_REG_MIN_MV_RAM_INDEX                 (19)    // registers_ram[] index
+#define RG_VDDA_REG_AVG_MV                           (2306)
+#define RG_VDDA_REG_AVG_MV_RAM_INDEX                 (20)    // registers_ram[] index
+#define RG_VDDA_REG_MAX_MV                           (2307)
+#define RG_VDDA_REG_MAX_MV_RAM_INDEX                 (21)    // registers_ram[] index
+#define RG_VDDA_REG_HEATER_ON_MIN_MV                 (2308)
+#define RG_VDDA_REG_HEATER_ON_MIN_MV_RAM_INDEX       (22)    // registers_ram[] index
+#define RG_VDDA_REG_SAGS_QTY                         (2309)
+#define RG_VDDA_REG_SAGS_QTY_RAM_INDEX               (23)    // registers_ram[] index
+#define RG_VDDA_REG_HEATER_SAGS_QTY                  (2310)
+#define RG_VDDA_REG_HEATER_SAGS_QTY_RAM_INDEX        (24)    // registers_ram[] index
+
+
+#define RG_CMD_NOP                                   (0)
+#define RG_CMD_REBOOT                                (1)
+#define RG_CMD_CLEAR_FLASH                           (2)
+#define RG_CMD_FLASH_COMMIT                          (3)     // RAM shadow -> FLASH (erase, program, CRC)
+
+#define RG_PROFILE_HDR_NAME_SIZE_OFFSET              (0)     // u8, 0 or 0xFF - no more profiles
+#define RG_PROFILE_HDR_STAGES_QTY_OFFSET             (1)     // u8
+#define RG_PROFILE_HDR_SIZE                          (2)
+#define RG_PROFILE_NAME_SIZE                         (18)    // max
+#define RG_PROFILE_STAGE_FLAGS_OFFSET                (0)     // u8, RG_PROFILE_STAGE_FLAG_x
+#define RG_PROFILE_STAGE_TEMPERATURE_C_OFFSET        (1)     // u8
+#define RG_PROFILE_STAGE_DURATION_S_OFFSET           (2)     // u16
+#define RG_PROFILE_STAGE_SIZE                        (4)
+#define RG_PROFILE_STAGE_FUN_PERIOD_S_OFFSET         (0)     // u16, after mandatory fields
+#define RG_PROFILE_STAGE_FUN_DUTY_CYCLE_PCT_OFFSET   (2)     // u8, after mandatory fields
+#define RG_PROFILE_STAGE_FUN_SIZE                    (3)
+#define RG_PROFILE_STAGE_FLAG_FUN                    (0x01)
+#define RG_PROFILE_STAGES_QTY                        (8)     // max
+#define RG_PROFILES_QTY                              (10)    // max
+
+
+#endif   // _REGISTERS_MAP_H_
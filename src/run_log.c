@@ -0,0 +1,134 @@
+//  ***************************************************************************
+/// @file    run_log.c
+/// @note    Every run is stored to FLASH as one @ref flash_log record at run
+///          stop, so FLASH is written only once per run.
+//  ***************************************************************************
+#include "run_log.h"
+#include "common/le_bytes.h"
+#include "outputs_driver.h"
+#include "system_operation.h"
+#include "error_handling.h"
+
+
+// Record data layout
+#define RUN_DATA_START_UPTIME_OFFSET    (0)    // u32, s
+#define RUN_DATA_DURATION_OFFSET        (4)    // u16, s
+#define RUN_DATA_FAIL_CODE_OFFSET       (6)    // u16
+#define RUN_DATA_PEAK_OFFSET            (8)    // u16, 0.1 C
+#define RUN_DATA_OVERSHOOT_OFFSET       (10)   // u16, 0.1 C
+#define RUN_DATA_PROFILE_INDEX_OFFSET   (12)   // u8
+#define RUN_DATA_RESULT_OFFSET          (13)   // u8
+#define RUN_DATA_LAST_STAGE_OFFSET      (14)   // u8
+
+
+static bool is_run_active;
+static run_log_record_t run;
+static uint32_t run_start_time_ms;
+
+
+
+
+void run_log_process(void) {
+    int32_t overshoot_c_x10;
+
+
+    if (!is_run_active) return;
+
+    if (heater_current_temperature_c_x10 > run.peak_temperature_c_x10) {
+        run.peak_temperature_c_x10 = heater_current_temperature_c_x10;
+    }
+    if (heater_target_temperature_c > 0) {
+        overshoot_c_x10 = (int32_t)heater_current_temperature_c_x10 - ((int32_t)heater_target_temperature_c * 10);
+        if (overshoot_c_x10 > run.max_overshoot_c_x10) run.max_overshoot_c_x10 = overshoot_c_x10;
+    }
+    if (so_current_stage_index != SO_STAGE_INDEX_NONE) {
+        run.last_stage_index = so_current_stage_index;
+    }
+}
+
+
+//  ***************************************************************************
+/// @brief  Start run statistics collection
+/// @param  profile_index - index of running profile
+/// @return none
+//  ***************************************************************************
+void run_log_start(uint8_t profile_index) {
+    run_start_time_ms = get_time_ms();
+    run.start_uptime_s = get_uptime_s();
+    run.duration_s = 0;
+    run.fail_code = 0;
+    run.peak_temperature_c_x10 = 0;
+    run.max_overshoot_c_x10 = 0;
+    run.profile_index = profile_index;
+    run.result = RUN_LOG_RESULT_DONE;
+    run.last_stage_index = SO_STAGE_INDEX_NONE;
+    is_run_active = true;
+}
+
+
+//  ***************************************************************************
+/// @brief  Stop run and store its record to FLASH
+/// @param  result - RUN_LOG_RESULT_x
+/// @return none
+/// @note   Does nothing if run is not started
+//  ***************************************************************************
+void run_log_stop(uint8_t result) {
+    uint8_t data[FLASH_LOG_RECORD_DATA_SIZE];
+    uint32_t duration_s;
+
+
+    if (!is_run_active) return;
+    is_run_active = false;
+
+    duration_s = (get_time_ms() - run_start_time_ms) / 1000;
+    if (duration_s > UINT16_MAX) duration_s = UINT16_MAX;
+
+    memset(data, 0, sizeof(data));
+    le_put_u32(&data[RUN_DATA_START_UPTIME_OFFSET], run.start_uptime_s);
+    le_put_u16(&data[RUN_DATA_DURATION_OFFSET], duration_s);
+    le_put_u16(&data[RUN_DATA_FAIL_CODE_OFFSET], fail_code);
+    le_put_u16(&data[RUN_DATA_PEAK_OFFSET], run.peak_temperature_c_x10);
+    le_put_u16(&data[RUN_DATA_OVERSHOOT_OFFSET], run.max_overshoot_c_x10);
+    data[RUN_DATA_PROFILE_INDEX_OFFSET] = run.profile_index;
+    data[RUN_DATA_RESULT_OFFSET] = result;
+    data[RUN_DATA_LAST_STAGE_OFFSET] = run.last_stage_index;
+
+    flash_log_append(FLASH_LOG_TYPE_RUN, data);
+}
+
+
+//  ***************************************************************************
+/// @brief  Get log span size in records
+/// @param  none
+/// @return records qty, use it as @ref run_log_read record_n limit
+//  ***************************************************************************
+uint32_t run_log_get_records_qty(void) {
+    return flash_log_get_records_qty();
+}
+
+
+//  ***************************************************************************
+/// @brief  Read run record
+/// @param  record_n - record number from the oldest one
+/// @param  record - pointer, can't be NULL
+/// @retval record
+/// @return true - success, false - record is broken or isn't a run record
+//  ***************************************************************************
+bool run_log_read(uint32_t record_n, run_log_record_t *record) {
+    flash_log_record_t log_record;
+
+
+    if (!flash_log_read(record_n, &log_record)) return false;
+    if (log_record.type != FLASH_LOG_TYPE_RUN) return false;
+
+    record->seq = log_record.seq;
+    record->start_uptime_s = le_get_u32(&log_record.data[RUN_DATA_START_UPTIME_OFFSET]);
+    record->duration_s = le_get_u16(&log_record.data[RUN_DATA_DURATION_OFFSET]);
+    record->fail_code = le_get_u16(&log_record.data[RUN_DATA_FAIL_CODE_OFFSET]);
+    record->peak_temperature_c_x10 = le_get_u16(&log_record.data[RUN_DATA_PEAK_OFFSET]);
+    record->max_overshoot_c_x10 = le_get_u16(&log_record.data[RUN_DATA_OVERSHOOT_OFFSET]);
+    record->profile_index = log_record.data[RUN_DATA_PROFILE_INDEX_OFFSET];
+    record->result = log_record.data[RUN_DATA_RESULT_OFFSET];
+    record->last_stage_index = log_record.data[RUN_DATA_LAST_STAGE_OFFSET];
+    return true;
+}
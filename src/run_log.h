@@ -0,0 +1,44 @@
+//  ***************************************************************************
+/// @file    run_log.h
+/// @brief   Persistent log of process runs
+//  ***************************************************************************
+#ifndef _RUN_LOG_H_
+#define _RUN_LOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "hal/systimer.h"
+#include "flash_log.h"
+
+
+// Run results
+#define RUN_LOG_RESULT_DONE         (0)
+#define RUN_LOG_RESULT_BREAK        (1)
+#define RUN_LOG_RESULT_FAIL         (2)
+#define RUN_LOG_RESULT_CLI_DBG      (3)
+
+
+typedef struct {
+    uint32_t seq;
+    uint32_t start_uptime_s;
+    uint16_t duration_s;
+    uint16_t fail_code;
+    uint16_t peak_temperature_c_x10;
+    uint16_t max_overshoot_c_x10;   // max temperature above stage setpoint
+    uint8_t  profile_index;
+    uint8_t  result;                // RUN_LOG_RESULT_x
+    uint8_t  last_stage_index;      // SO_STAGE_INDEX_NONE - process not started
+} run_log_record_t;
+
+
+extern void run_log_process(void);
+
+extern void run_log_start(uint8_t profile_index);
+extern void run_log_stop(uint8_t result);
+
+extern uint32_t run_log_get_records_qty(void);
+extern bool run_log_read(uint32_t record_n, run_log_record_t *record);
+
+
+#endif   // _RUN_LOG_H_
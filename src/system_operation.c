@@ -15,10 +15,18 @@ typedef enum {
 
 
 bool is_cli_dbg_mode;
+uint8_t so_current_stage_index;
+
+static system_operation_process_state_t so_process_state = SO_PROCESS_STATE_INTRO;
+// One button event per pass, events not used by the current state are dropped
+static button_event_t button_event;
+static bool is_button_event;
 
 
 static bool is_any_button_event(void);
-static void clear_all_buttons_events_flags(void);
+static bool is_button_event_of(button_t *button, button_event_type_t type);
+static void clear_all_buttons_events(void);
+static void update_clock_profile(void);
 
 
 static button_t select_button = {
@@ -39,17 +47,20 @@ void system_operation_init(void) {
     button_init(&select_button);
     button_init(&start_button);
     outputs_init();
+    trace_init();
 
     is_cli_dbg_mode = false;
+    so_current_stage_index = SO_STAGE_INDEX_NONE;
 }
 
 
 void system_operation_process(void) {
-    static system_operation_process_state_t so_process_state = SO_PROCESS_STATE_INTRO;
     static bool is_state_init = true;
-    static timer_t process_timer, process_stage_timer, update_process_screen_timer;
+    static timer_t process_timer, process_start_timer, process_stage_timer, update_process_screen_timer;
     static uint8_t profile_index, process_stage_index;
-    static int32_t common_process_time_s;
+    static profile_plan_t plan;
+    static uint32_t process_time_s;
+    const profile_plan_stage_t *stage;
     uint8_t error_msg[8];
 
 
@@ -57,16 +68,27 @@ void system_operation_process(void) {
     indicators_process();
     outputs_process();
     button_process();
+    run_log_process();
+    is_button_event = button_get_event(&button_event);
 
 
     if ((fail_code != 0) && (so_process_state != SO_PROCESS_STATE_FAIL)) {
+        so_current_stage_index = SO_STAGE_INDEX_NONE;
+        trace_stop();
+        flash_set_idle_commit_hold(false);
+        run_log_stop(RUN_LOG_RESULT_FAIL);
         is_state_init = true;
         so_process_state = SO_PROCESS_STATE_FAIL;
     }
     if ((is_cli_dbg_mode) && (so_process_state != SO_PROCESS_STATE_CLI_DBG)) {
+        so_current_stage_index = SO_STAGE_INDEX_NONE;
+        trace_stop();
+        flash_set_idle_commit_hold(false);
+        run_log_stop(RUN_LOG_RESULT_CLI_DBG);
         is_state_init = true;
         so_process_state = SO_PROCESS_STATE_CLI_DBG;
     }
+    update_clock_profile();
 
 
     switch (so_process_state) {
@@ -89,7 +111,7 @@ void system_operation_process(void) {
             if (is_state_init) {
                 gui_reset_standby_timer();
                 gui_print_profiles_menu_screen(profile_index);
-                clear_all_buttons_events_flags();
+                clear_all_buttons_events();
                 is_state_init = false;
             }
 
@@ -97,17 +119,31 @@ void system_operation_process(void) {
             if (gui_is_standby) {
                 if (is_any_button_event()) gui_reset_standby_timer();
             }
-            // Select next item
-            else if (button_is_press_event(&select_button)) {
+            // Select the first item
+            else if (is_button_event_of(&select_button, BUTTON_EVENT_DOUBLE_CLICK)) {
+                profile_index = 0;
+                gui_reset_standby_timer();
+                gui_print_profiles_menu_screen(profile_index);
+            }
+            // Select next item, hold to scroll
+            else if (is_button_event_of(&select_button, BUTTON_EVENT_CLICK) || is_button_event_of(&select_button, BUTTON_EVENT_HOLD_REPEAT)) {
                 profile_index++;
                 if (profile_index >= active_profiles_qty) profile_index = 0;
                 gui_reset_standby_timer();
                 gui_print_profiles_menu_screen(profile_index);
             }
             // Start process
-            else if (button_is_press_event(&start_button)) {
-                is_state_init = true;
-                so_process_state = SO_PROCESS_STATE_PROCESS;
+            else if (is_button_event_of(&start_button, BUTTON_EVENT_CLICK)) {
+                if (profiles_load(profile_index, &plan)) {
+                    is_state_init = true;
+                    so_process_state = SO_PROCESS_STATE_PROCESS;
+                }
+                else {
+                    gui_print_center_msg("INVALID");
+                    process_timer = timer_start_ms(2000);
+                    is_state_init = true;
+                    so_process_state = SO_PROCESS_STATE_PROCESS_RESULT_SCREEN;
+                }
             }
             break;
 
@@ -115,23 +151,29 @@ void system_operation_process(void) {
         case SO_PROCESS_STATE_PROCESS:
             if (is_state_init) {
                 gui_reset_standby_timer();
-                common_process_time_s = 0;
-                for (process_stage_index = 0; process_stage_index < RG_PROFILE_STAGES_QTY; process_stage_index++) {
-                    common_process_time_s += profiles[profile_index].stages[process_stage_index].duration_s;
-                }
+                process_start_timer = timer_start_ms(0);
+                update_process_screen_timer = timer_restart_ms(process_start_timer, 1000);
+                process_time_s = 0;
                 process_stage_index = 0;
+                trace_start();
+                flash_set_idle_commit_hold(true);
+                run_log_start(profile_index);
                 indicators_buzzer_short_beep();
                 indicators_led_process(true);
-                clear_all_buttons_events_flags();
+                clear_all_buttons_events();
             }
 
             // Break process
-            if (button_is_long_press_event(&select_button) || button_is_long_press_event(&start_button)) {
+            if (is_button_event_of(&select_button, BUTTON_EVENT_LONG_PRESS) || is_button_event_of(&start_button, BUTTON_EVENT_LONG_PRESS)) {
                 fun_dis();
                 heater_dis();
                 indicators_buzzer_short_beep();
                 indicators_led_process(false);
                 gui_print_center_msg("BREAK");
+                so_current_stage_index = SO_STAGE_INDEX_NONE;
+                trace_stop();
+                flash_set_idle_commit_hold(false);
+                run_log_stop(RUN_LOG_RESULT_BREAK);
                 process_timer = timer_start_ms(2000);
                 is_state_init = true;
                 so_process_state = SO_PROCESS_STATE_PROCESS_RESULT_SCREEN;
@@ -139,15 +181,17 @@ void system_operation_process(void) {
             // Stage done
             else if (is_state_init || timer_triggered(process_stage_timer)) {
                 // Next process stage
-                if ((process_stage_index < RG_PROFILE_STAGES_QTY) && (profiles[profile_index].stages[process_stage_index].duration_s > 0)) {
-                    gui_print_process_screen_init(profiles[profile_index].stages[process_stage_index].temperature_c);
-                    gui_update_process_screen(heater_current_temperature_c, common_process_time_s);
+                if (process_stage_index < plan.stages_qty) {
+                    stage = &plan.stages[process_stage_index];
+                    gui_print_process_screen_init(stage->temperature_c);
+                    gui_update_process_screen(heater_current_temperature_c, (plan.total_time_s - process_time_s));
 
-                    fun_en(profiles[profile_index].stages[process_stage_index].fun_period_s, profiles[profile_index].stages[process_stage_index].fun_duty_cycle_pct);
-                    heater_en(profiles[profile_index].stages[process_stage_index].temperature_c);
+                    fun_en(stage->fun_period_s, stage->fun_duty_cycle_pct);
+                    heater_en(stage->temperature_c);
 
-                    process_stage_timer = timer_start_ms(profiles[profile_index].stages[process_stage_index].duration_s * 1000);
-                    update_process_screen_timer = timer_start_ms(1000);
+                    // Stages end times are absolute, so stage switching doesn't accumulate drift
+                    process_stage_timer = timer_restart_ms(process_start_timer, (stage->end_time_s * 1000));
+                    so_current_stage_index = process_stage_index;
                     process_stage_index++;
                     is_state_init = false;
                 }
@@ -158,6 +202,10 @@ void system_operation_process(void) {
                     indicators_buzzer_process_done_beep();
                     indicators_led_process(false);
                     gui_print_center_msg("DONE");
+                    so_current_stage_index = SO_STAGE_INDEX_NONE;
+                    trace_stop();
+                    flash_set_idle_commit_hold(false);
+                    run_log_stop(RUN_LOG_RESULT_DONE);
                     process_timer = timer_start_ms(10000);
                     is_state_init = true;
                     so_process_state = SO_PROCESS_STATE_PROCESS_RESULT_SCREEN;
@@ -170,8 +218,8 @@ void system_operation_process(void) {
             // Update process screen
             else if (timer_triggered(update_process_screen_timer)) {
                 update_process_screen_timer = timer_restart_ms(update_process_screen_timer, 1000);
-                if (common_process_time_s > 0) common_process_time_s--;
-                gui_update_process_screen(heater_current_temperature_c, common_process_time_s);
+                if (process_time_s < plan.total_time_s) process_time_s++;
+                gui_update_process_screen(heater_current_temperature_c, (plan.total_time_s - process_time_s));
             }
             break;
 
@@ -180,7 +228,7 @@ void system_operation_process(void) {
             if (is_state_init) {
                 // process_timer is set from calling state !
                 gui_reset_standby_timer();
-                clear_all_buttons_events_flags();
+                clear_all_buttons_events();
                 is_state_init = false;
             }
             if (timer_triggered(process_timer) || is_any_button_event()) {
@@ -200,7 +248,7 @@ void system_operation_process(void) {
                 gui_reset_standby_timer();
                 indicators_buzzer_error_beep();
                 indicators_led_error(true);
-                clear_all_buttons_events_flags();
+                clear_all_buttons_events();
                 is_state_init = false;
             }
 
@@ -220,7 +268,7 @@ void system_operation_process(void) {
                 gui_reset_standby_timer();
                 indicators_buzzer_error_beep();
                 indicators_led_error(true);
-                clear_all_buttons_events_flags();
+                clear_all_buttons_events();
                 is_state_init = false;
             }
 
@@ -232,21 +280,73 @@ void system_operation_process(void) {
 }
 
 
+//  ***************************************************************************
+/// @brief  Get system operation state
+/// @param  none
+/// @return state, for diagnostics only
+//  ***************************************************************************
+uint8_t system_operation_get_state(void) {
+    return (uint8_t)so_process_state;
+}
+
+
 
 
 static bool is_any_button_event(void) {
-    bool result = false;
+    return is_button_event;
+}
 
-    result |= button_is_press_event(&start_button);
-    result |= button_is_long_press_event(&start_button);
-    result |= button_is_press_event(&select_button);
-    result |= button_is_long_press_event(&select_button);
 
-    return result;
+static bool is_button_event_of(button_t *button, button_event_type_t type) {
+    return is_button_event && (button_event.button == button) && (button_event.type == type);
 }
 
 
-static void clear_all_buttons_events_flags(void) {
-    button_clear_events_flags(&start_button);
-    button_clear_events_flags(&select_button);
+static void clear_all_buttons_events(void) {
+    button_flush_events();
+    is_button_event = false;
+}
+
+
+//  ***************************************************************************
+/// @brief  Select MCU clock profile by system state
+/// @param  none
+/// @return none
+/// @note   Low power only while idle in menu with display off and USB not
+///         enumerated. USB has no clock in low power, so it's disconnected
+///         from the bus (D+ pull-up off). Board has no VBUS sense, so every
+///         SO_USB_PROBE_PERIOD_MS NORMAL profile is set and USB is connected
+///         for SO_USB_PROBE_WINDOW_MS. Device enumerated by host in the
+///         window stays in NORMAL while USB is connected, otherwise it goes
+///         back to low power. Any button also wakes it up.
+//  ***************************************************************************
+static void update_clock_profile(void) {
+    static timer_t usb_probe_timer;
+    static bool is_usb_probe = false;
+    bool is_normal = (mcu_clock_get_profile() == MCU_CLOCK_PROFILE_NORMAL);
+
+
+    if ((so_process_state != SO_PROCESS_STATE_PROFILE_SELECTION) || !gui_is_standby || usb_cdc_is_usb_connected()) {
+        if (!is_normal && (mcu_clock_set_profile(MCU_CLOCK_PROFILE_NORMAL) == E_OK)) usb_cdc_start();
+        is_usb_probe = false;
+        return;
+    }
+
+    if (is_normal) {
+        if (is_usb_probe && !timer_triggered(usb_probe_timer)) return;
+        usb_cdc_stop();
+        mcu_clock_set_profile(MCU_CLOCK_PROFILE_LOW_POWER);
+        usb_probe_timer = timer_start_ms(SO_USB_PROBE_PERIOD_MS);
+        is_usb_probe = false;
+    }
+    else if (timer_triggered(usb_probe_timer)) {
+        if (mcu_clock_set_profile(MCU_CLOCK_PROFILE_NORMAL) == E_OK) {
+            usb_cdc_start();
+            usb_probe_timer = timer_start_ms(SO_USB_PROBE_WINDOW_MS);
+            is_usb_probe = true;
+        }
+        else {
+            usb_probe_timer = timer_start_ms(SO_USB_PROBE_PERIOD_MS);
+        }
+    }
 }
@@ -18,13 +18,26 @@
 #include "profiles.h"
 #include "outputs_driver.h"
 #include "error_handling.h"
+#include "trace.h"
+#include "run_log.h"
+#include "mcu_clock.h"
+#include "usb_cdc.h"
+
+
+#define SO_STAGE_INDEX_NONE (0xFF)
+
+// Idle in LOW_POWER: USB is connected for enumeration window every period
+#define SO_USB_PROBE_PERIOD_MS  (30000)
+#define SO_USB_PROBE_WINDOW_MS  (3000)
 
 
 extern bool is_cli_dbg_mode;
+extern uint8_t so_current_stage_index;
 
 
 extern void system_operation_init(void);
 extern void system_operation_process(void);
+extern uint8_t system_operation_get_state(void);
 
 
 #endif   // _SYSTEM_OPERATION_H_
@@ -0,0 +1,87 @@
+//  ***************************************************************************
+/// @file    telemetry.c
+//  ***************************************************************************
+#include "telemetry.h"
+#include "common/le_bytes.h"
+#include "outputs_driver.h"
+#include "system_operation.h"
+#include "vdda_monitor.h"
+
+
+static uint32_t telemetry_period_ms;
+static timer_t telemetry_timer;
+static uint16_t telemetry_seq;
+static uint32_t prev_timestamp_ms;
+static uint32_t prev_heater_on_time_ms;
+
+
+
+
+//  ***************************************************************************
+/// @brief  Start telemetry records generation
+/// @param  period_ms - records period, TELEMETRY_MIN_PERIOD_MS..TELEMETRY_MAX_PERIOD_MS
+/// @return none
+//  ***************************************************************************
+void telemetry_start(uint32_t period_ms) {
+    telemetry_period_ms = period_ms;
+    telemetry_seq = 0;
+    prev_timestamp_ms = get_time_ms();
+    prev_heater_on_time_ms = heater_get_on_time_ms();
+    telemetry_timer = timer_start_ms(0);
+}
+
+
+//  ***************************************************************************
+/// @brief  Build telemetry record if record period is over
+/// @param  record - pointer to TELEMETRY_RECORD_SIZE buffer, can't be NULL
+/// @retval record
+/// @return true - record is ready
+/// @note   Sequence number is incremented for every built record, so if caller
+///         drops a record (no space in TX buffer) host will see the gap.
+//  ***************************************************************************
+bool telemetry_is_record_ready(uint8_t *record) {
+    uint32_t timestamp_ms, heater_on_time_ms, heater_duty_pct;
+    vdda_monitor_stat_t vdda_stat;
+    uint8_t stage_index, checksum;
+    uint32_t i;
+
+
+    if (!timer_triggered(telemetry_timer)) return false;
+    telemetry_timer = timer_restart_ms(telemetry_timer, telemetry_period_ms);
+    // Main loop was busy longer than record period: don't try to catch up
+    if (timer_triggered(telemetry_timer)) telemetry_timer = timer_start_ms(telemetry_period_ms);
+
+    timestamp_ms = get_time_ms();
+    heater_on_time_ms = heater_get_on_time_ms();
+    heater_duty_pct = 0;
+    if (timestamp_ms != prev_timestamp_ms) {
+        heater_duty_pct = ((heater_on_time_ms - prev_heater_on_time_ms) * 100) / (timestamp_ms - prev_timestamp_ms);
+        if (heater_duty_pct > 100) heater_duty_pct = 100;
+    }
+    prev_timestamp_ms = timestamp_ms;
+    prev_heater_on_time_ms = heater_on_time_ms;
+
+    stage_index = so_current_stage_index;
+    if (stage_index > TELEMETRY_STATE_STAGE_INDEX_NONE) stage_index = TELEMETRY_STATE_STAGE_INDEX_NONE;
+
+    record[TELEMETRY_RECORD_SYNC_OFFSET] = TELEMETRY_RECORD_SYNC_0;
+    record[TELEMETRY_RECORD_SYNC_OFFSET + 1] = TELEMETRY_RECORD_SYNC_1;
+    le_put_u16(&record[TELEMETRY_RECORD_SEQ_OFFSET], telemetry_seq);
+    le_put_u32(&record[TELEMETRY_RECORD_TIMESTAMP_OFFSET], timestamp_ms);
+    le_put_u16(&record[TELEMETRY_RECORD_ADC_RAW_OFFSET], heater_temperature_sensor_adc_raw);
+    le_put_u16(&record[TELEMETRY_RECORD_TEMP_X10_OFFSET], heater_current_temperature_c_x10);
+    record[TELEMETRY_RECORD_SETPOINT_OFFSET] = heater_target_temperature_c;
+    record[TELEMETRY_RECORD_HEATER_DUTY_OFFSET] = (uint8_t)heater_duty_pct;
+    record[TELEMETRY_RECORD_STATE_OFFSET] = (is_heater_pin_en ? TELEMETRY_STATE_HEATER_PIN_MSK : 0) |
+                                            (is_fun_pin_en ? TELEMETRY_STATE_FUN_PIN_MSK : 0) |
+                                            (stage_index << TELEMETRY_STATE_STAGE_INDEX_POS);
+    vdda_monitor_get_stat(&vdda_stat);
+    le_put_u16(&record[TELEMETRY_RECORD_VDDA_OFFSET], vdda_stat.vdda_mv);
+
+    checksum = 0;
+    for (i = 0; i < TELEMETRY_RECORD_CHECKSUM_OFFSET; i++) checksum += record[i];
+    record[TELEMETRY_RECORD_CHECKSUM_OFFSET] = checksum;
+
+    telemetry_seq++;
+    return true;
+}
@@ -0,0 +1,42 @@
+//  ***************************************************************************
+/// @file    telemetry.h
+/// @brief   Binary process telemetry
+//  ***************************************************************************
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "hal/systimer.h"
+
+
+#define TELEMETRY_MIN_PERIOD_MS      (1)   // 1 kHz
+#define TELEMETRY_MAX_PERIOD_MS      (60 * 1000)
+
+// Record layout (little endian), see tlog_decoder.py
+#define TELEMETRY_RECORD_SYNC_0      (0xA5)
+#define TELEMETRY_RECORD_SYNC_1      (0x5A)
+#define TELEMETRY_RECORD_SYNC_OFFSET        (0)    // u8[2]
+#define TELEMETRY_RECORD_SEQ_OFFSET         (2)    // u16, incremented for each record, dropped records too
+#define TELEMETRY_RECORD_TIMESTAMP_OFFSET   (4)    // u32, ms
+#define TELEMETRY_RECORD_ADC_RAW_OFFSET     (8)    // u16, heater sensor ADC code
+#define TELEMETRY_RECORD_TEMP_X10_OFFSET    (10)   // u16, heater temperature, 0.1 C
+#define TELEMETRY_RECORD_SETPOINT_OFFSET    (12)   // u8, heater target temperature, C (0 - heater disabled)
+#define TELEMETRY_RECORD_HEATER_DUTY_OFFSET (13)   // u8, heater ON time since previous record, %
+#define TELEMETRY_RECORD_STATE_OFFSET       (14)   // u8, bit 0 - heater pin, bit 1 - fun pin, bits 4..7 - stage index (0xF - none)
+#define TELEMETRY_RECORD_VDDA_OFFSET        (15)   // u16, VDDA, mV
+#define TELEMETRY_RECORD_CHECKSUM_OFFSET    (17)   // u8, sum of bytes 0..16
+#define TELEMETRY_RECORD_SIZE               (18)
+
+#define TELEMETRY_STATE_HEATER_PIN_MSK      (1 << 0)
+#define TELEMETRY_STATE_FUN_PIN_MSK         (1 << 1)
+#define TELEMETRY_STATE_STAGE_INDEX_POS     (4)
+#define TELEMETRY_STATE_STAGE_INDEX_NONE    (0x0F)
+
+
+extern void telemetry_start(uint32_t period_ms);
+extern bool telemetry_is_record_ready(uint8_t *record);
+
+
+#endif   // _TELEMETRY_H_
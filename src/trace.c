@@ -0,0 +1,237 @@
+//  ***************************************************************************
+/// @file    trace.c
+/// @note    Trace is a ring of fixed-size blocks, the oldest block is dropped
+///          when the ring is full. Every block starts with absolute sample
+///          (header), so any block can be decoded alone. Next samples are
+///          stored as 1 byte: bits 7..4 - signed temperature delta in 0.5 C
+///          units (-7..+7), bits 3..0 - heater duty (0..15 -> 0..100 %).
+///          Delta code -8 is escape: absolute temperature and setpoint follow.
+//  ***************************************************************************
+#include "trace.h"
+#include "common/le_bytes.h"
+#include "outputs_driver.h"
+
+
+// Block header
+#define TRACE_HDR_TIME_S_OFFSET         (0)   // u16
+#define TRACE_HDR_TEMPERATURE_OFFSET    (2)   // u16, 0.1 C
+#define TRACE_HDR_SETPOINT_OFFSET       (4)   // u8
+#define TRACE_HDR_DUTY_OFFSET           (5)   // u8, %
+#define TRACE_HDR_USED_SIZE_OFFSET      (6)   // u8, including header
+#define TRACE_HDR_SIZE                  (7)
+
+#define TRACE_SAMPLE_SIZE               (1)
+#define TRACE_ESCAPE_SAMPLE_SIZE        (4)   // code, u16 temperature, u8 setpoint
+#define TRACE_DELTA_ESCAPE              (-8)
+#define TRACE_DELTA_MAX                 (7)
+#define TRACE_DELTA_UNIT_X10            (5)   // 0.5 C
+#define TRACE_DUTY_MAX_CODE             (15)
+
+
+static uint8_t trace_buff[TRACE_BLOCKS_QTY][TRACE_BLOCK_SIZE];
+static uint32_t trace_head_block, trace_blocks_qty;
+static bool is_trace_recording;
+static timer_wheel_timer_t trace_timer;
+static uint16_t trace_time_s;
+static uint16_t trace_last_temperature_c_x10;
+static uint8_t trace_last_setpoint_c;
+static uint32_t prev_heater_on_time_ms;
+
+
+static void trace_timer_callback(void *arg);
+static void trace_add_sample(const trace_sample_t *sample);
+static void trace_new_block(const trace_sample_t *sample);
+
+
+
+
+void trace_init(void) {
+    trace_head_block = 0;
+    trace_blocks_qty = 0;
+    is_trace_recording = false;
+}
+
+
+//  ***************************************************************************
+/// @brief  Start new trace
+/// @param  none
+/// @return none
+/// @note   Previous trace is cleared
+//  ***************************************************************************
+void trace_start(void) {
+    trace_head_block = 0;
+    trace_blocks_qty = 0;
+    trace_time_s = 0;
+    prev_heater_on_time_ms = heater_get_on_time_ms();
+    timer_wheel_start(&trace_timer, 0, TRACE_SAMPLE_PERIOD_MS, trace_timer_callback, NULL);
+    is_trace_recording = true;
+}
+
+
+//  ***************************************************************************
+/// @brief  Stop trace recording
+/// @param  none
+/// @return none
+/// @note   Recorded data is kept until next @ref trace_start
+//  ***************************************************************************
+void trace_stop(void) {
+    timer_wheel_stop(&trace_timer);
+    is_trace_recording = false;
+}
+
+
+bool trace_is_recording(void) {
+    return is_trace_recording;
+}
+
+
+//  ***************************************************************************
+/// @brief  Init trace iterator (from the oldest sample)
+/// @param  iterator - pointer, can't be NULL
+/// @retval iterator
+/// @return none
+//  ***************************************************************************
+void trace_iterator_init(trace_iterator_t *iterator) {
+    iterator->block_n = 0;
+    iterator->offset = 0;
+}
+
+
+//  ***************************************************************************
+/// @brief  Get next trace sample
+/// @param  iterator - pointer, can't be NULL
+/// @param  sample - pointer, can't be NULL
+/// @retval iterator
+/// @retval sample
+/// @return false - no more samples
+//  ***************************************************************************
+bool trace_iterator_next(trace_iterator_t *iterator, trace_sample_t *sample) {
+    const uint8_t *block;
+    uint8_t code;
+    int8_t delta;
+
+
+    while (iterator->block_n < trace_blocks_qty) {
+        block = trace_buff[(trace_head_block + iterator->block_n) % TRACE_BLOCKS_QTY];
+
+        // Header sample
+        if (iterator->offset == 0) {
+            iterator->sample.time_s = le_get_u16(&block[TRACE_HDR_TIME_S_OFFSET]);
+            iterator->sample.temperature_c_x10 = le_get_u16(&block[TRACE_HDR_TEMPERATURE_OFFSET]);
+            iterator->sample.setpoint_c = block[TRACE_HDR_SETPOINT_OFFSET];
+            iterator->sample.heater_duty_pct = block[TRACE_HDR_DUTY_OFFSET];
+            iterator->offset = TRACE_HDR_SIZE;
+            *sample = iterator->sample;
+            return true;
+        }
+
+        if (iterator->offset < block[TRACE_HDR_USED_SIZE_OFFSET]) {
+            code = block[iterator->offset];
+            delta = (int8_t)code >> 4;   // signed high nibble
+            iterator->sample.time_s++;
+            iterator->sample.heater_duty_pct = ((uint32_t)(code & 0x0F) * 100) / TRACE_DUTY_MAX_CODE;
+            if (delta == TRACE_DELTA_ESCAPE) {
+                iterator->sample.temperature_c_x10 = le_get_u16(&block[iterator->offset + 1]);
+                iterator->sample.setpoint_c = block[iterator->offset + 3];
+                iterator->offset += TRACE_ESCAPE_SAMPLE_SIZE;
+            }
+            else {
+                iterator->sample.temperature_c_x10 += delta * TRACE_DELTA_UNIT_X10;
+                iterator->offset += TRACE_SAMPLE_SIZE;
+            }
+            *sample = iterator->sample;
+            return true;
+        }
+
+        iterator->block_n++;
+        iterator->offset = 0;
+    }
+    return false;
+}
+
+
+
+
+static void trace_timer_callback(void *arg) {
+    trace_sample_t sample;
+    uint32_t heater_on_time_ms, heater_duty_pct;
+
+
+    heater_on_time_ms = heater_get_on_time_ms();
+    heater_duty_pct = ((heater_on_time_ms - prev_heater_on_time_ms) * 100) / TRACE_SAMPLE_PERIOD_MS;
+    if (heater_duty_pct > 100) heater_duty_pct = 100;
+    prev_heater_on_time_ms = heater_on_time_ms;
+
+    sample.time_s = trace_time_s;
+    sample.temperature_c_x10 = heater_current_temperature_c_x10;
+    sample.setpoint_c = heater_target_temperature_c;
+    sample.heater_duty_pct = heater_duty_pct;
+    trace_add_sample(&sample);
+    trace_time_s++;
+}
+
+
+static void trace_add_sample(const trace_sample_t *sample) {
+    uint8_t *block;
+    int32_t delta;
+    uint8_t duty_code, used_size;
+
+
+    if (trace_blocks_qty == 0) {
+        trace_new_block(sample);
+        return;
+    }
+    block = trace_buff[(trace_head_block + trace_blocks_qty - 1) % TRACE_BLOCKS_QTY];
+    used_size = block[TRACE_HDR_USED_SIZE_OFFSET];
+
+    // Rounded delta against reconstructed (not real) temperature, so error isn't accumulated
+    delta = (int32_t)sample->temperature_c_x10 - trace_last_temperature_c_x10;
+    if (delta >= 0) delta = (delta + (TRACE_DELTA_UNIT_X10 / 2)) / TRACE_DELTA_UNIT_X10;
+    else delta = (delta - (TRACE_DELTA_UNIT_X10 / 2)) / TRACE_DELTA_UNIT_X10;
+    duty_code = ((uint32_t)sample->heater_duty_pct * TRACE_DUTY_MAX_CODE + 50) / 100;
+
+    if ((delta > TRACE_DELTA_MAX) || (delta < -TRACE_DELTA_MAX) || (sample->setpoint_c != trace_last_setpoint_c)) {
+        if ((used_size + TRACE_ESCAPE_SAMPLE_SIZE) > TRACE_BLOCK_SIZE) {
+            trace_new_block(sample);
+            return;
+        }
+        block[used_size] = ((uint8_t)TRACE_DELTA_ESCAPE << 4) | duty_code;
+        le_put_u16(&block[used_size + 1], sample->temperature_c_x10);
+        block[used_size + 3] = sample->setpoint_c;
+        block[TRACE_HDR_USED_SIZE_OFFSET] = used_size + TRACE_ESCAPE_SAMPLE_SIZE;
+        trace_last_temperature_c_x10 = sample->temperature_c_x10;
+        trace_last_setpoint_c = sample->setpoint_c;
+    }
+    else {
+        if ((used_size + TRACE_SAMPLE_SIZE) > TRACE_BLOCK_SIZE) {
+            trace_new_block(sample);
+            return;
+        }
+        block[used_size] = ((uint8_t)delta << 4) | duty_code;
+        block[TRACE_HDR_USED_SIZE_OFFSET] = used_size + TRACE_SAMPLE_SIZE;
+        trace_last_temperature_c_x10 += delta * TRACE_DELTA_UNIT_X10;
+    }
+}
+
+
+static void trace_new_block(const trace_sample_t *sample) {
+    uint8_t *block;
+
+
+    if (trace_blocks_qty < TRACE_BLOCKS_QTY) {
+        trace_blocks_qty++;
+    }
+    else {
+        // Drop the oldest block
+        trace_head_block = (trace_head_block + 1) % TRACE_BLOCKS_QTY;
+    }
+    block = trace_buff[(trace_head_block + trace_blocks_qty - 1) % TRACE_BLOCKS_QTY];
+
+    le_put_u16(&block[TRACE_HDR_TIME_S_OFFSET], sample->time_s);
+    le_put_u16(&block[TRACE_HDR_TEMPERATURE_OFFSET], sample->temperature_c_x10);
+    block[TRACE_HDR_SETPOINT_OFFSET] = sample->setpoint_c;
+    block[TRACE_HDR_DUTY_OFFSET] = sample->heater_duty_pct;
+    block[TRACE_HDR_USED_SIZE_OFFSET] = TRACE_HDR_SIZE;
+    trace_last_temperature_c_x10 = sample->temperature_c_x10;
+    trace_last_setpoint_c = sample->setpoint_c;
+}
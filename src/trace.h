@@ -0,0 +1,44 @@
+//  ***************************************************************************
+/// @file    trace.h
+/// @brief   RAM trace of process data
+//  ***************************************************************************
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "hal/timer_wheel.h"
+
+
+#define TRACE_SAMPLE_PERIOD_MS      (1000)
+#define TRACE_BLOCK_SIZE            (64)
+#define TRACE_BLOCKS_QTY            (24)    // ~1 min per block
+
+
+typedef struct {
+    uint16_t time_s;              // from process start
+    uint16_t temperature_c_x10;   // 0.1 C
+    uint8_t  setpoint_c;
+    uint8_t  heater_duty_pct;
+} trace_sample_t;
+
+typedef struct {
+    // Private
+    uint32_t block_n;
+    uint32_t offset;
+    trace_sample_t sample;
+} trace_iterator_t;
+
+
+extern void trace_init(void);
+
+extern void trace_start(void);
+extern void trace_stop(void);
+extern bool trace_is_recording(void);
+
+extern void trace_iterator_init(trace_iterator_t *iterator);
+extern bool trace_iterator_next(trace_iterator_t *iterator, trace_sample_t *sample);
+
+
+#endif   // _TRACE_H_
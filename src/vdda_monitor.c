@@ -0,0 +1,81 @@
+//  ***************************************************************************
+/// @file    vdda_monitor.c
+/// @note    VDDA is measured by VREFINT channel. Sag is a drop below
+///          VDDA_MONITOR_SAG_THRESHOLD_MV, the first one raises
+///          WARNING_CODE_VDDA_SAG (sample value is journal context, bit 16 -
+///          heater pin was ON).
+//  ***************************************************************************
+#include "vdda_monitor.h"
+#include "error_handling.h"
+
+
+#define AVG_SHIFT           (6)    // 1/64 weight of new sample
+
+
+static vdda_monitor_stat_t stat;
+static uint32_t avg_mv_scaled;     // avg_mv << AVG_SHIFT
+static bool is_sag;
+static bool is_first_sample;
+
+
+
+
+void vdda_monitor_init(void) {
+    vdda_monitor_reset_stat();
+    is_sag = false;
+}
+
+
+//  ***************************************************************************
+/// @brief  Process VDDA sample
+/// @param  vdda_mv
+/// @param  is_heater_on - heater pin state
+/// @return none
+//  ***************************************************************************
+void vdda_monitor_sample(uint16_t vdda_mv, bool is_heater_on) {
+    stat.vdda_mv = vdda_mv;
+
+    if (is_first_sample) {
+        stat.min_mv = vdda_mv;
+        stat.max_mv = vdda_mv;
+        avg_mv_scaled = (uint32_t)vdda_mv << AVG_SHIFT;
+        is_first_sample = false;
+    }
+    if (vdda_mv < stat.min_mv) stat.min_mv = vdda_mv;
+    if (vdda_mv > stat.max_mv) stat.max_mv = vdda_mv;
+    avg_mv_scaled = avg_mv_scaled - (avg_mv_scaled >> AVG_SHIFT) + vdda_mv;
+    stat.avg_mv = (uint16_t)(avg_mv_scaled >> AVG_SHIFT);
+    if (is_heater_on && (vdda_mv < stat.heater_on_min_mv)) stat.heater_on_min_mv = vdda_mv;
+
+    if (!is_sag && (vdda_mv < VDDA_MONITOR_SAG_THRESHOLD_MV)) {
+        is_sag = true;
+        if (stat.sags_qty < UINT16_MAX) stat.sags_qty++;
+        if (is_heater_on && (stat.heater_sags_qty < UINT16_MAX)) stat.heater_sags_qty++;
+        eh_set_warn_vdda_sag(vdda_mv | (is_heater_on ? (1 << 16) : 0));
+    }
+    else if (is_sag && (vdda_mv > (VDDA_MONITOR_SAG_THRESHOLD_MV + VDDA_MONITOR_SAG_HYSTERESIS_MV))) {
+        is_sag = false;
+    }
+}
+
+
+void vdda_monitor_get_stat(vdda_monitor_stat_t *vdda_stat) {
+    *vdda_stat = stat;
+}
+
+
+//  ***************************************************************************
+/// @brief  Reset statistics, the next sample starts them
+/// @param  none
+/// @return none
+/// @note   Sag in progress isn't counted again
+//  ***************************************************************************
+void vdda_monitor_reset_stat(void) {
+    stat.min_mv = 0;
+    stat.avg_mv = 0;
+    stat.max_mv = 0;
+    stat.heater_on_min_mv = UINT16_MAX;
+    stat.sags_qty = 0;
+    stat.heater_sags_qty = 0;
+    is_first_sample = true;
+}
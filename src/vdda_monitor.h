@@ -0,0 +1,34 @@
+//  ***************************************************************************
+/// @file    vdda_monitor.h
+/// @brief   VDDA statistics and sags correlated with heater switching
+//  ***************************************************************************
+#ifndef _VDDA_MONITOR_H_
+#define _VDDA_MONITOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#define VDDA_MONITOR_SAG_THRESHOLD_MV     (3000)   // 3.3 V nominal
+#define VDDA_MONITOR_SAG_HYSTERESIS_MV    (50)
+
+
+typedef struct {
+    uint16_t vdda_mv;              // the last sample
+    uint16_t min_mv;
+    uint16_t avg_mv;               // exponential, ~64 samples
+    uint16_t max_mv;
+    uint16_t heater_on_min_mv;     // min while heater pin is ON
+    uint16_t sags_qty;
+    uint16_t heater_sags_qty;      // sags started while heater pin is ON
+} vdda_monitor_stat_t;
+
+
+extern void vdda_monitor_init(void);
+extern void vdda_monitor_sample(uint16_t vdda_mv, bool is_heater_on);
+
+extern void vdda_monitor_get_stat(vdda_monitor_stat_t *vdda_stat);
+extern void vdda_monitor_reset_stat(void);
+
+
+#endif  // _VDDA_MONITOR_H_
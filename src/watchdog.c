@@ -0,0 +1,130 @@
+//  ***************************************************************************
+/// @file    watchdog.c
+/// @note    IWDG can't be stopped once started. It is refreshed from the main
+///          loop only while every task has checked in within its deadline, so
+///          a stuck loop anywhere (e.g. I2C clock stretching) resets MCU and
+///          heater output returns to its reset state (off).
+//  ***************************************************************************
+#include "watchdog.h"
+#include "common/mcu.h"
+#include "hal/systimer.h"
+#include "error_handling.h"
+
+
+#define IWDG_KEY_START          (0xCCCC)
+#define IWDG_KEY_UNLOCK         (0x5555)
+#define IWDG_KEY_REFRESH        (0xAAAA)
+#define IWDG_PRESCALER_64       (4)
+#define IWDG_LSI_FREQ_HZ        (40'000)
+#define IWDG_RELOAD             ((WATCHDOG_TIMEOUT_MS * (IWDG_LSI_FREQ_HZ / 64)) / 1000)
+
+
+static const uint16_t tasks_deadlines_ms[WATCHDOG_TASKS_QTY] = {
+    [WATCHDOG_TASK_CONTROL]     = 500,
+    [WATCHDOG_TASK_MEASUREMENT] = 1000,
+    [WATCHDOG_TASK_GUI]         = 1000,
+    [WATCHDOG_TASK_CLI]         = 1000,
+};
+
+static uint32_t tasks_check_in_time_ms[WATCHDOG_TASKS_QTY];
+static uint32_t stalled_tasks_mask;
+static uint32_t reset_flags;
+static bool is_started;
+
+
+
+
+//  ***************************************************************************
+/// @brief  Watchdog init: detect reset cause
+/// @param  none
+/// @return none
+/// @note   Should be called after error_handling_init()
+//  ***************************************************************************
+void watchdog_init(void) {
+    reset_flags = RCC->CSR;
+    RCC->CSR |= RCC_CSR_RMVF;    // Clear reset flags for the next boot
+
+    if (reset_flags & (RCC_CSR_IWDGRSTF | RCC_CSR_WWDGRSTF)) eh_set_warn_err_wdt_reset(reset_flags);
+
+    stalled_tasks_mask = 0;
+    is_started = false;
+}
+
+
+//  ***************************************************************************
+/// @brief  Start IWDG, all tasks are considered alive at this moment
+/// @param  none
+/// @return none
+/// @note   Should be called just before main loop: initialization may block
+///         longer than watchdog timeout
+//  ***************************************************************************
+void watchdog_start(void) {
+    uint32_t i;
+
+
+    for (i = 0; i < WATCHDOG_TASKS_QTY; i++) {
+        tasks_check_in_time_ms[i] = get_time_ms();
+    }
+
+    IWDG->KR = IWDG_KEY_START;
+    IWDG->KR = IWDG_KEY_UNLOCK;
+    IWDG->PR = IWDG_PRESCALER_64;
+    IWDG->RLR = IWDG_RELOAD;
+    while (IWDG->SR != 0) ;      // Wait for registers update
+    IWDG->KR = IWDG_KEY_REFRESH;
+    is_started = true;
+}
+
+
+//  ***************************************************************************
+/// @brief  Refresh IWDG if every task is alive
+/// @param  none
+/// @return none
+//  ***************************************************************************
+void watchdog_process(void) {
+    uint32_t i, time_ms;
+
+
+    if (!is_started) return;
+
+    time_ms = get_time_ms();
+    for (i = 0; i < WATCHDOG_TASKS_QTY; i++) {
+        if ((time_ms - tasks_check_in_time_ms[i]) > tasks_deadlines_ms[i]) {
+            stalled_tasks_mask |= (1 << i);
+        }
+    }
+
+    if (stalled_tasks_mask == 0) IWDG->KR = IWDG_KEY_REFRESH;
+}
+
+
+//  ***************************************************************************
+/// @brief  Task liveness check-in
+/// @param  task - @ref watchdog_task_t
+/// @return none
+/// @note   Missed deadline isn't forgiven by later check-in: reset follows
+//  ***************************************************************************
+void watchdog_check_in(watchdog_task_t task) {
+    if (task >= WATCHDOG_TASKS_QTY) return;
+    tasks_check_in_time_ms[task] = get_time_ms();
+}
+
+
+//  ***************************************************************************
+/// @brief  Check reset cause
+/// @param  none
+/// @return true - the last reset was made by watchdog
+//  ***************************************************************************
+bool watchdog_is_wdt_reset(void) {
+    return ((reset_flags & (RCC_CSR_IWDGRSTF | RCC_CSR_WWDGRSTF)) != 0);
+}
+
+
+//  ***************************************************************************
+/// @brief  Get tasks which missed deadline
+/// @param  none
+/// @return mask (1 << @ref watchdog_task_t), reset is pending if not 0
+//  ***************************************************************************
+uint32_t watchdog_get_stalled_tasks_mask(void) {
+    return stalled_tasks_mask;
+}
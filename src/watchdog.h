@@ -0,0 +1,34 @@
+//  ***************************************************************************
+/// @file    watchdog.h
+/// @brief   Independent watchdog with per-task liveness check-ins
+//  ***************************************************************************
+#ifndef _WATCHDOG_H_
+#define _WATCHDOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#define WATCHDOG_TIMEOUT_MS           (2000)   // IWDG, LSI 40 kHz typ. (30..50 kHz)
+
+
+// Every task should check in within its deadline, otherwise IWDG isn't refreshed
+typedef enum {
+    WATCHDOG_TASK_CONTROL = 0,    // Heater control
+    WATCHDOG_TASK_MEASUREMENT,    // Fresh heater temperature from ADC
+    WATCHDOG_TASK_GUI,
+    WATCHDOG_TASK_CLI,
+    WATCHDOG_TASKS_QTY
+} watchdog_task_t;
+
+
+extern void watchdog_init(void);
+extern void watchdog_start(void);
+extern void watchdog_process(void);
+
+extern void watchdog_check_in(watchdog_task_t task);
+extern bool watchdog_is_wdt_reset(void);
+extern uint32_t watchdog_get_stalled_tasks_mask(void);
+
+
+#endif  // _WATCHDOG_H_
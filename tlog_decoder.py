@@ -0,0 +1,93 @@
+import serial
+import struct
+import sys
+
+
+port = "COM10"
+baudrate = 115200
+period_ms = 1
+out_file_name = "tlog.csv"
+
+
+# See src/telemetry.h
+RECORD_SYNC = b"\xA5\x5A"
+RECORD_SIZE = 18
+RECORD_FORMAT = "<2sHIHHBBBHB"
+STAGE_INDEX_NONE = 0x0F
+
+
+
+def decode_record(data:bytes):
+    if (sum(data[0:RECORD_SIZE - 1]) & 0xFF) != data[RECORD_SIZE - 1]:
+        return None
+    sync, seq, timestamp_ms, adc_raw, temp_x10, setpoint_c, heater_duty_pct, state, vdda_mv, checksum = struct.unpack(RECORD_FORMAT, data)
+    stage_index = state >> 4
+    return {
+        "seq": seq,
+        "timestamp_ms": timestamp_ms,
+        "adc_raw": adc_raw,
+        "temperature_c": temp_x10 / 10,
+        "setpoint_c": setpoint_c,
+        "heater_duty_pct": heater_duty_pct,
+        "heater_pin": state & 0x01,
+        "fun_pin": (state >> 1) & 0x01,
+        "stage_index": -1 if stage_index == STAGE_INDEX_NONE else stage_index,
+        "vdda_mv": vdda_mv
+    }
+
+
+def decode_stream(buff:bytearray, on_record):
+    while True:
+        pos = buff.find(RECORD_SYNC)
+        if pos < 0:
+            del buff[:max(0, len(buff) - 1)]
+            return
+        if (len(buff) - pos) < RECORD_SIZE:
+            del buff[:pos]
+            return
+        record = decode_record(bytes(buff[pos:pos + RECORD_SIZE]))
+        if record is None:
+            del buff[:pos + 1]   # false sync, resync on next byte
+            continue
+        on_record(record)
+        del buff[:pos + RECORD_SIZE]
+
+
+
+
+if __name__ == "__main__":
+    # Usage: tlog_decoder.py [raw_dump_file] - decode raw dump instead of serial port
+    out = open(out_file_name, "w")
+    out.write("seq;timestamp_ms;adc_raw;temperature_c;setpoint_c;heater_duty_pct;heater_pin;fun_pin;stage_index;vdda_mv\n")
+    state = {"prev_seq": None, "lost": 0, "qty": 0}
+
+    def on_record(record):
+        if state["prev_seq"] is not None:
+            state["lost"] += (record["seq"] - state["prev_seq"] - 1) & 0xFFFF
+        state["prev_seq"] = record["seq"]
+        state["qty"] += 1
+        out.write(";".join(str(record[key]) for key in ("seq", "timestamp_ms", "adc_raw", "temperature_c", "setpoint_c", "heater_duty_pct", "heater_pin", "fun_pin", "stage_index", "vdda_mv")) + "\n")
+
+    buff = bytearray()
+    if len(sys.argv) > 1:
+        with open(sys.argv[1], "rb") as f:
+            buff += f.read()
+        decode_stream(buff, on_record)
+    else:
+        ser = serial.Serial(port, baudrate=baudrate)
+        ser.timeout = 0.1
+        ser.write(b"\r")
+        ser.read_until(b">", 100)
+        ser.write(("tlog " + str(period_ms) + " bin\r").encode())
+        print("Logging to " + out_file_name + ", Ctrl-C to stop\r\n")
+        try:
+            while True:
+                buff += ser.read(4096)
+                decode_stream(buff, on_record)
+        except KeyboardInterrupt:
+            pass
+        ser.write(b"\x03")   # Control-C - stop tlog
+        ser.close()
+
+    out.close()
+    print("Records: " + str(state["qty"]) + ", lost: " + str(state["lost"]) + "\r\n")